@@ -0,0 +1,60 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Async/VivoxAsync.h"
+
+FVivoxCancellationToken::FVivoxCancellationToken()
+	: State(MakeShared<FState>())
+{
+}
+
+void FVivoxCancellationToken::Cancel() const
+{
+	check(IsInGameThread());
+	if (State->bCancelled)
+		return;
+
+	State->bCancelled = true;
+	//Moved out first so a callback can register on the token again
+	TMap<FDelegateHandle, TFunction<void()>> Callbacks = MoveTemp(State->Callbacks);
+	State->Callbacks.Reset();
+	for (TPair<FDelegateHandle, TFunction<void()>>& Callback : Callbacks)
+	{
+		Callback.Value();
+	}
+}
+
+bool FVivoxCancellationToken::IsCancelled() const
+{
+	return State->bCancelled;
+}
+
+FDelegateHandle FVivoxCancellationToken::OnCancelled(TFunction<void()>&& OnCancel) const
+{
+	check(IsInGameThread());
+	if (State->bCancelled)
+	{
+		OnCancel();
+		return FDelegateHandle();
+	}
+	const FDelegateHandle Handle(FDelegateHandle::GenerateNewHandle);
+	State->Callbacks.Add(Handle, MoveTemp(OnCancel));
+	return Handle;
+}
+
+void FVivoxCancellationToken::RemoveOnCancelled(FDelegateHandle Handle) const
+{
+	check(IsInGameThread());
+	State->Callbacks.Remove(Handle);
+}
+
+namespace VivoxAsync
+{
+	TFuture<bool> WhenAllSucceeded(TArray<TFuture<bool>>&& Futures)
+	{
+		return WhenAll(MoveTemp(Futures)).Then([](TFuture<TArray<bool>> Results)
+			{
+				return !Results.Get().Contains(false);
+			});
+	}
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Components/VivoxChannelAssignmentComponent.h"
+//Subsystem
+#include "Subsystem/VivoxSubSystem.h"
+//
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
+
+FOnVivoxServerAssignmentsChanged UVivoxChannelAssignmentComponent::OnServerAssignmentsChanged;
+
+void FVivoxChannelAssignmentArray::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (OwnerComponent != nullptr)
+	{
+		OwnerComponent->ApplyAssignments();
+	}
+}
+
+UVivoxChannelAssignmentComponent::UVivoxChannelAssignmentComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+	Assignments.OwnerComponent = this;
+}
+
+void UVivoxChannelAssignmentComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	//Membership of other players is none of this client's business
+	DOREPLIFETIME_CONDITION(UVivoxChannelAssignmentComponent, Assignments, COND_OwnerOnly);
+}
+
+void UVivoxChannelAssignmentComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		OnServerAssignmentsChanged.Broadcast(this);
+	}
+
+	//Assignments made before the component began play (initial replication , server setup on spawn)
+	if (Assignments.Items.Num() > 0 && IsLocallyControlled())
+	{
+		ApplyAssignments();
+	}
+}
+
+//Server
+
+void UVivoxChannelAssignmentComponent::AssignChannel(const FString& ChannelSessionId, EVivoxChannelType ChannelType, bool bListenAudio, bool bTransmitAudio, bool bConnectText)
+{
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Voice channel %s can only be assigned on the server"), *ChannelSessionId);
+		return;
+	}
+
+	if (ChannelSessionId == "")
+	{
+		UE_LOG(LogVivox, Error, TEXT("Provided ChannelSessionId is empty cannot assign voice channel"));
+		return;
+	}
+
+	const int32 Index = FindAssignment(ChannelSessionId, ChannelType);
+	FVivoxChannelAssignment& Assignment = (Index != INDEX_NONE) ? Assignments.Items[Index] : Assignments.Items.AddDefaulted_GetRef();
+
+	//Unchanged entries are not marked dirty so nothing is sent
+	if (Index != INDEX_NONE && Assignment.bListenAudio == bListenAudio && Assignment.bTransmitAudio == bTransmitAudio && Assignment.bConnectText == bConnectText)
+		return;
+
+	Assignment.ChannelSessionId = ChannelSessionId;
+	Assignment.ChannelType = ChannelType;
+	Assignment.bListenAudio = bListenAudio;
+	Assignment.bTransmitAudio = bTransmitAudio;
+	Assignment.bConnectText = bConnectText;
+	Assignments.MarkItemDirty(Assignment);
+	OnAssignmentsChanged();
+}
+
+void UVivoxChannelAssignmentComponent::UnassignChannel(const FString& ChannelSessionId, EVivoxChannelType ChannelType)
+{
+	if (GetOwnerRole() != ROLE_Authority)
+		return;
+
+	const int32 Index = FindAssignment(ChannelSessionId, ChannelType);
+	if (Index == INDEX_NONE)
+		return;
+
+	Assignments.Items.RemoveAtSwap(Index);
+	Assignments.MarkArrayDirty();
+	OnAssignmentsChanged();
+}
+
+void UVivoxChannelAssignmentComponent::ClearAssignedChannels()
+{
+	if (GetOwnerRole() != ROLE_Authority || Assignments.Items.Num() == 0)
+		return;
+
+	Assignments.Items.Reset();
+	Assignments.MarkArrayDirty();
+	OnAssignmentsChanged();
+}
+
+void UVivoxChannelAssignmentComponent::OnAssignmentsChanged()
+{
+	if (HasBegunPlay())
+	{
+		OnServerAssignmentsChanged.Broadcast(this);
+	}
+
+	//The listen server host gets no replication , changes made in the same frame are applied together on the next tick
+	if (!IsLocallyControlled() || bLocalApplyPending)
+		return;
+
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+		return;
+
+	bLocalApplyPending = true;
+	World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(this, [this]()
+		{
+			bLocalApplyPending = false;
+			ApplyAssignments();
+		}));
+}
+
+const FString& UVivoxChannelAssignmentComponent::GetOrCreateVivoxAccountName()
+{
+	//Unique per player and only made of characters vivox account names allow
+	if (VivoxAccountName.IsEmpty())
+	{
+		VivoxAccountName = TEXT("p") + FGuid::NewGuid().ToString(EGuidFormats::Digits).ToLower();
+	}
+	return VivoxAccountName;
+}
+
+void UVivoxChannelAssignmentComponent::SendVivoxTokens(const TArray<FVivoxIssuedToken>& Tokens)
+{
+	if (GetOwnerRole() != ROLE_Authority || Tokens.Num() == 0)
+		return;
+
+	ClientReceiveVivoxTokens(Tokens);
+}
+
+int32 UVivoxChannelAssignmentComponent::FindAssignment(const FString& ChannelSessionId, EVivoxChannelType ChannelType) const
+{
+	return Assignments.Items.IndexOfByPredicate([&ChannelSessionId, ChannelType](const FVivoxChannelAssignment& Assignment)
+		{
+			return Assignment.ChannelType == ChannelType && Assignment.ChannelSessionId == ChannelSessionId;
+		});
+}
+
+//Both
+
+TArray<FVivoxDesiredChannel> UVivoxChannelAssignmentComponent::GetAssignedChannels() const
+{
+	TArray<FVivoxDesiredChannel> Channels;
+	Channels.Reserve(Assignments.Items.Num());
+	for (const FVivoxChannelAssignment& Assignment : Assignments.Items)
+	{
+		FVivoxDesiredChannel& Channel = Channels.AddDefaulted_GetRef();
+		Channel.ChannelSessionId = Assignment.ChannelSessionId;
+		Channel.ChannelType = Assignment.ChannelType;
+		Channel.bListenAudio = Assignment.bListenAudio;
+		Channel.bTransmitAudio = Assignment.bTransmitAudio;
+		Channel.bConnectText = Assignment.bConnectText;
+	}
+	return Channels;
+}
+
+bool UVivoxChannelAssignmentComponent::IsLocallyControlled() const
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (PlayerController == nullptr)
+	{
+		if (const APawn* Pawn = Cast<APawn>(GetOwner()))
+		{
+			PlayerController = Pawn->GetController<APlayerController>();
+		}
+	}
+	return PlayerController != nullptr && PlayerController->IsLocalController();
+}
+
+//Client
+
+void UVivoxChannelAssignmentComponent::ClientReceiveVivoxTokens_Implementation(const TArray<FVivoxIssuedToken>& Tokens)
+{
+	const UWorld* World = GetWorld();
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	UVivoxSubSystem* VivoxSubsystem = GameInstance ? GameInstance->GetSubsystem<UVivoxSubSystem>() : nullptr;
+	if (VivoxSubsystem == nullptr || !VivoxSubsystem->IsVivoxAvailable())
+		return;
+
+	UE_LOG(LogVivox, Log, TEXT("Received %d server issued vivox tokens"), Tokens.Num());
+	VivoxSubsystem->SetExternalTokens(Tokens);
+}
+
+void UVivoxChannelAssignmentComponent::ApplyAssignments()
+{
+	const UWorld* World = GetWorld();
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	UVivoxSubSystem* VivoxSubsystem = GameInstance ? GameInstance->GetSubsystem<UVivoxSubSystem>() : nullptr;
+	if (VivoxSubsystem == nullptr || !VivoxSubsystem->IsVivoxAvailable())
+		return;
+
+	const TArray<FVivoxDesiredChannel> Channels = GetAssignedChannels();
+	UE_LOG(LogVivox, Log, TEXT("Applying %d server assigned voice channels"), Channels.Num());
+	VivoxSubsystem->SetDesiredChannels(Channels);
+	OnAssignmentsApplied.Broadcast(Channels);
+}
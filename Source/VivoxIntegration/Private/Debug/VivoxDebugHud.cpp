@@ -0,0 +1,139 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Debug/VivoxDebugHud.h"
+//Subsystem
+#include "Subsystem/VivoxSubSystem.h"
+//
+#include "Debug/DebugDrawService.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/Font.h"
+#include "GameFramework/PlayerController.h"
+#include "CanvasItem.h"
+
+namespace VivoxDebugHud
+{
+	static const int32 MaxParticipantsPerChannel = 8;
+	static const float EnergyBarWidth = 80.0f;
+	static const float Indent = 16.0f;
+
+	static FString StateToString(ConnectionState State)
+	{
+		return UEnum::GetDisplayValueAsText(State).ToString();
+	}
+}
+
+FVivoxDebugHud::FVivoxDebugHud(UVivoxSubSystem* InSubsystem)
+	: Subsystem(InSubsystem)
+{
+	DrawHandle = UDebugDrawService::Register(TEXT("Game"), FDebugDrawDelegate::CreateRaw(this, &FVivoxDebugHud::Draw));
+}
+
+FVivoxDebugHud::~FVivoxDebugHud()
+{
+	UDebugDrawService::Unregister(DrawHandle);
+}
+
+void FVivoxDebugHud::Draw(UCanvas* Canvas, APlayerController* PlayerController)
+{
+	UVivoxSubSystem* VivoxSubsystem = Subsystem.Get();
+	if (VivoxSubsystem == nullptr || Canvas == nullptr)
+		return;
+
+	//The draw service is global , every play in editor viewport only shows the hud of its own game instance
+	if (PlayerController == nullptr || PlayerController->GetGameInstance() != VivoxSubsystem->GetGameInstance())
+		return;
+
+	UFont* Font = GEngine->GetSmallFont();
+	const float LineHeight = Font->GetMaxCharHeight() + 2.0f;
+	const float X = 40.0f;
+	float Y = 60.0f;
+
+	const int32 NumChannels = VivoxSubsystem->EchoChannels.Num() + VivoxSubsystem->NonPostionalChannels.Num() + VivoxSubsystem->PositionalChannels.Num();
+	Canvas->SetDrawColor(FColor::White);
+	Canvas->DrawText(Font, FString::Printf(TEXT("Vivox  logged in: %s  channels: %d  bootstrap: %s"),
+		VivoxSubsystem->bIsLoggedIn ? TEXT("yes") : TEXT("no"), NumChannels,
+		*UEnum::GetDisplayValueAsText(VivoxSubsystem->GetVivoxBootstrapStage()).ToString()), X, Y);
+	Y += LineHeight;
+
+	for (const TMap<FString, UVivoxChannelObject*>* Registry : { &VivoxSubsystem->EchoChannels, &VivoxSubsystem->NonPostionalChannels, &VivoxSubsystem->PositionalChannels })
+	{
+		for (const TPair<FString, UVivoxChannelObject*>& Pair : *Registry)
+		{
+			if (IsValid(Pair.Value))
+			{
+				Y = DrawChannel(Canvas, Pair.Value, X, Y);
+			}
+		}
+	}
+}
+
+float FVivoxDebugHud::DrawChannel(UCanvas* Canvas, const UVivoxChannelObject* ChannelObject, float X, float Y) const
+{
+	UFont* Font = GEngine->GetSmallFont();
+	const float LineHeight = Font->GetMaxCharHeight() + 2.0f;
+
+	const bool bConnected = ChannelObject->GetChannelConnectionState() == ConnectionState::Connected;
+	Canvas->SetDrawColor(bConnected ? FColor::Green : FColor::Yellow);
+
+	FString Flags;
+	if (ChannelObject->IsAudioIdleSuspended())
+	{
+		Flags += TEXT(" [idle]");
+	}
+	if (ChannelObject->IsBudgetDemoted())
+	{
+		Flags += TEXT(" [demoted]");
+	}
+
+	const float JoinLatency = ChannelObject->GetLastJoinLatency();
+	const FString JoinText = JoinLatency >= 0.0f ? FString::Printf(TEXT("%.0f ms"), JoinLatency * 1000.0f) : FString(TEXT("-"));
+	Canvas->DrawText(Font, FString::Printf(TEXT("%s (%s)  channel: %s  audio: %s  text: %s  participants: %d  pos: %.1f/s  join: %s%s"),
+		*ChannelObject->GetChannelSessionId(),
+		*UEnum::GetDisplayValueAsText(ChannelObject->GetChannelType()).ToString(),
+		*VivoxDebugHud::StateToString(ChannelObject->GetChannelConnectionState()),
+		*VivoxDebugHud::StateToString(ChannelObject->GetAudioConnectionState()),
+		*VivoxDebugHud::StateToString(ChannelObject->GetTextConnectionState()),
+		ChannelObject->GetNumParticipants(),
+		ChannelObject->GetPositionUpdateRate(),
+		*JoinText,
+		*Flags), X, Y);
+	Y += LineHeight;
+
+	int32 NumDrawn = 0;
+	for (const TPair<FString, FVivoxParticipantState>& Pair : ChannelObject->GetParticipantMap())
+	{
+		if (NumDrawn == VivoxDebugHud::MaxParticipantsPerChannel)
+		{
+			Canvas->SetDrawColor(FColor::Silver);
+			Canvas->DrawText(Font, FString::Printf(TEXT("+%d more"), ChannelObject->GetNumParticipants() - NumDrawn), X + VivoxDebugHud::Indent, Y);
+			Y += LineHeight;
+			break;
+		}
+
+		const FVivoxParticipantState& Participant = Pair.Value;
+		const float BarX = X + VivoxDebugHud::Indent;
+		const float BarHeight = LineHeight - 4.0f;
+
+		FCanvasTileItem Background(FVector2D(BarX, Y + 2.0f), FVector2D(VivoxDebugHud::EnergyBarWidth, BarHeight), FLinearColor(0.1f, 0.1f, 0.1f, 0.6f));
+		Background.BlendMode = SE_BLEND_Translucent;
+		Canvas->DrawItem(Background);
+
+		const float Energy = FMath::Clamp(static_cast<float>(Participant.AudioEnergy), 0.0f, 1.0f);
+		if (Energy > 0.0f)
+		{
+			FCanvasTileItem Bar(FVector2D(BarX, Y + 2.0f), FVector2D(VivoxDebugHud::EnergyBarWidth * Energy, BarHeight), Participant.bSpeechDetected ? FLinearColor::Green : FLinearColor::Gray);
+			Canvas->DrawItem(Bar);
+		}
+
+		Canvas->SetDrawColor(Participant.bSpeechDetected ? FColor::Green : FColor::White);
+		Canvas->DrawText(Font, FString::Printf(TEXT("%s%s%s"),
+			Participant.DisplayName.IsEmpty() ? *Participant.AccountName : *Participant.DisplayName,
+			Participant.bIsSelf ? TEXT(" (self)") : TEXT(""),
+			Participant.bInAudio ? TEXT("") : TEXT(" [no audio]")), BarX + VivoxDebugHud::EnergyBarWidth + 6.0f, Y);
+		Y += LineHeight;
+		++NumDrawn;
+	}
+	return Y;
+}
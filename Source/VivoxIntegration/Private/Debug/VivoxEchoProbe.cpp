@@ -0,0 +1,195 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Debug/VivoxEchoProbe.h"
+//Objects
+#include "Objects/VivoxChannelObject.h"
+//
+
+namespace VivoxEchoProbe
+{
+	//Participant update rate of the loopback , close to the rate the sdk reports energy at
+	static const double LoopbackUpdateInterval = 0.05;
+	//Words are kept shorter than the round trip so the echo is a burst of its own
+	static const float LoopbackMaxWordSeconds = 0.12f;
+	static const float LoopbackClipChance = 0.03f;
+
+	//Nearest rank percentile of sorted values
+	static float Percentile(const TArray<float>& SortedValues, float Percent)
+	{
+		if (SortedValues.Num() == 0)
+			return 0.0f;
+
+		const int32 Rank = FMath::CeilToInt(Percent * SortedValues.Num());
+		return SortedValues[FMath::Clamp(Rank - 1, 0, SortedValues.Num() - 1)];
+	}
+}
+
+//Probe
+
+FVivoxEchoProbe::FVivoxEchoProbe(float InReturnEnergyThreshold, float InClipEnergy, float InMaxRoundTripSeconds)
+	: ReturnEnergyThreshold(InReturnEnergyThreshold)
+	, ClipEnergy(InClipEnergy)
+	, MaxRoundTripSeconds(InMaxRoundTripSeconds)
+	, StartTime(FPlatformTime::Seconds())
+{
+}
+
+void FVivoxEchoProbe::AddSelfSample(double Time, bool bSpeechDetected, double Energy)
+{
+	//Half threshold to go inactive so energy hovering around the threshold is one burst
+	const bool bActive = bSelfActive ? (bSpeechDetected || Energy >= ReturnEnergyThreshold * 0.5) : (bSpeechDetected || Energy >= ReturnEnergyThreshold);
+	if (bActive && !bSelfActive)
+	{
+		ExpirePendingOnsets(Time);
+		bEchoBurst = PendingOnsets.Num() > 0;
+		if (bEchoBurst)
+		{
+			RoundTripsMs.Add(static_cast<float>((Time - PendingOnsets[0]) * 1000.0));
+			PendingOnsets.RemoveAt(0, 1, false);
+		}
+		else
+		{
+			PendingOnsets.Add(Time);
+		}
+	}
+	bSelfActive = bActive;
+
+	if (bActive && !bEchoBurst && bSpeechDetected)
+	{
+		const float Level = static_cast<float>(Energy);
+		InputLevelSum += Level;
+		++InputLevelSamples;
+		InputLevelPeak = FMath::Max(InputLevelPeak, Level);
+		if (Level >= ClipEnergy)
+		{
+			++ClippedSamples;
+		}
+	}
+}
+
+void FVivoxEchoProbe::ExpirePendingOnsets(double Time)
+{
+	int32 NumExpired = 0;
+	while (NumExpired < PendingOnsets.Num() && Time - PendingOnsets[NumExpired] > MaxRoundTripSeconds)
+	{
+		++NumExpired;
+	}
+	if (NumExpired > 0)
+	{
+		PendingOnsets.RemoveAt(0, NumExpired, false);
+		MissedRoundTrips += NumExpired;
+	}
+}
+
+FVivoxSelfTestResult FVivoxEchoProbe::GetResult(double Time) const
+{
+	FVivoxSelfTestResult Result;
+	Result.DurationSeconds = static_cast<float>(Time - StartTime);
+	Result.RoundTrips = RoundTripsMs.Num();
+	Result.MissedRoundTrips = MissedRoundTrips;
+
+	if (RoundTripsMs.Num() > 0)
+	{
+		TArray<float> Sorted = RoundTripsMs;
+		Sorted.Sort();
+		Result.LatencyMinMs = Sorted[0];
+		Result.LatencyP50Ms = VivoxEchoProbe::Percentile(Sorted, 0.50f);
+		Result.LatencyP90Ms = VivoxEchoProbe::Percentile(Sorted, 0.90f);
+		Result.LatencyP99Ms = VivoxEchoProbe::Percentile(Sorted, 0.99f);
+		Result.LatencyMaxMs = Sorted.Last();
+	}
+
+	if (InputLevelSamples > 0)
+	{
+		Result.InputLevelAverage = static_cast<float>(InputLevelSum / InputLevelSamples);
+		Result.ClippedRatio = static_cast<float>(ClippedSamples) / InputLevelSamples;
+	}
+	Result.InputLevelPeak = InputLevelPeak;
+	return Result;
+}
+
+SIZE_T FVivoxEchoProbe::GetAllocatedSize() const
+{
+	return PendingOnsets.GetAllocatedSize() + RoundTripsMs.GetAllocatedSize();
+}
+
+//Loopback
+
+FVivoxLoopbackEchoSource::FVivoxLoopbackEchoSource(UVivoxChannelObject* InChannel, float InLatencySeconds, float InJitterSeconds)
+	: Channel(InChannel)
+	, LatencySeconds(InLatencySeconds)
+	, JitterSeconds(InJitterSeconds)
+{
+	Self.ParticipantId = TEXT("sip:loopback-self");
+	Self.AccountName = TEXT("loopback-self");
+	Self.DisplayName = TEXT("Loopback");
+	Self.bIsSelf = true;
+	Self.bInAudio = true;
+}
+
+void FVivoxLoopbackEchoSource::Start(double Time)
+{
+	UVivoxChannelObject* ChannelObject = Channel.Get();
+	if (ChannelObject == nullptr)
+		return;
+
+	ChannelObject->HandleChannelStateChanged(ConnectionState::Connected);
+	ChannelObject->HandleAudioStateChanged(ConnectionState::Connected);
+	ChannelObject->HandleConnectCompleted(true);
+	ChannelObject->HandleParticipantAdded(Self);
+
+	NextToggleTime = Time + 0.5;
+	NextUpdateTime = Time;
+	LastReturnTime = Time;
+}
+
+void FVivoxLoopbackEchoSource::Tick(double Time)
+{
+	UVivoxChannelObject* ChannelObject = Channel.Get();
+	if (ChannelObject == nullptr)
+		return;
+
+	//Synthetic talker , short words separated by pauses longer than the round trip
+	if (Time >= NextToggleTime)
+	{
+		bTalking = !bTalking;
+		const float WordSeconds = FMath::Min(VivoxEchoProbe::LoopbackMaxWordSeconds, FMath::Max(LatencySeconds - JitterSeconds, 0.05f) * 0.6f);
+		NextToggleTime = Time + (bTalking ? WordSeconds : LatencySeconds + JitterSeconds + FMath::FRandRange(0.8f, 1.5f));
+	}
+
+	//The echo of earlier updates reaches the speakers , the microphone picks it up as self energy
+	int32 NumReturned = 0;
+	while (NumReturned < PendingReturns.Num() && PendingReturns[NumReturned].Time <= Time)
+	{
+		CurrentReturn = PendingReturns[NumReturned];
+		++NumReturned;
+	}
+	if (NumReturned > 0)
+	{
+		PendingReturns.RemoveAt(0, NumReturned, false);
+	}
+
+	if (Time >= NextUpdateTime)
+	{
+		NextUpdateTime = Time + VivoxEchoProbe::LoopbackUpdateInterval;
+
+		const double SpokenEnergy = bTalking ? (FMath::FRand() < VivoxEchoProbe::LoopbackClipChance ? 1.0 : FMath::FRandRange(0.3f, 0.8f)) : FMath::FRandRange(0.0f, 0.05f);
+
+		FPendingReturn Return;
+		Return.Time = FMath::Max(LastReturnTime, Time + FMath::Max(0.0f, LatencySeconds + FMath::FRandRange(-JitterSeconds, JitterSeconds)));
+		Return.bSpeechDetected = bTalking;
+		Return.Energy = SpokenEnergy * 0.5;
+		LastReturnTime = Return.Time;
+		PendingReturns.Add(Return);
+
+		Self.bSpeechDetected = bTalking || CurrentReturn.bSpeechDetected;
+		Self.AudioEnergy = FMath::Max(SpokenEnergy, CurrentReturn.Energy);
+		ChannelObject->HandleParticipantUpdated(Self);
+	}
+}
+
+SIZE_T FVivoxLoopbackEchoSource::GetAllocatedSize() const
+{
+	return PendingReturns.GetAllocatedSize();
+}
@@ -3,9 +3,33 @@
 
 #include "Library/VivoxHelperLibrary.h"
 #include "Misc/Guid.h"
+#include "Hash/CityHash.h"
 
 FString UVivoxHelperLibrary::GenerateUUID()
 {
 	FGuid UUID = FGuid::NewGuid();
 	return UUID.ToString();
 }
+
+int32 UVivoxHelperLibrary::JumpConsistentHash(uint64 Key, int32 NumBuckets)
+{
+	if (NumBuckets <= 1)
+		return 0;
+
+	int64 Bucket = -1;
+	int64 Jump = 0;
+	while (Jump < NumBuckets)
+	{
+		Bucket = Jump;
+		Key = Key * 2862933555777941757ULL + 1;
+		Jump = static_cast<int64>((Bucket + 1) * (static_cast<double>(1LL << 31) / static_cast<double>((Key >> 33) + 1)));
+	}
+	return static_cast<int32>(Bucket);
+}
+
+int32 UVivoxHelperLibrary::GetChannelShardIndex(const FString& PlayerId, int32 ShardCount)
+{
+	//Hash the utf8 bytes so the shard does not depend on the platform TCHAR size
+	const FTCHARToUTF8 Utf8(*PlayerId);
+	return JumpConsistentHash(CityHash64(Utf8.Get(), Utf8.Length()), ShardCount);
+}
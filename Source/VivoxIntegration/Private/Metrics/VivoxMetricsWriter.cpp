@@ -0,0 +1,165 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Metrics/VivoxMetricsWriter.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+
+FVivoxMetricsWriter::FVivoxMetricsWriter(const FString& InDirectory, const FString& InFileName, int32 InMaxQueuedRecords, int64 InMaxFileBytes, int32 InMaxFiles)
+	: Directory(InDirectory)
+	, FileName(InFileName)
+	, MaxQueuedRecords(FMath::Max(InMaxQueuedRecords, 1))
+	, MaxFileBytes(FMath::Max<int64>(InMaxFileBytes, 1024))
+	, MaxFiles(FMath::Max(InMaxFiles, 1))
+{
+	BeginSession();
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("VivoxMetricsWriter"), 0, TPri_BelowNormal);
+}
+
+FVivoxMetricsWriter::~FVivoxMetricsWriter()
+{
+	if (Thread != nullptr)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FVivoxMetricsWriter::BeginSession()
+{
+	SessionId = FGuid::NewGuid().ToString(EGuidFormats::DigitsLower);
+	SessionStartTime = FPlatformTime::Seconds();
+}
+
+void FVivoxMetricsWriter::Record(const TCHAR* Event, TFunctionRef<void(FVivoxMetricsJsonWriter&)> Fill)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	{
+		FScopeLock Lock(&QueueLock);
+		if (Queue.Num() >= MaxQueuedRecords)
+		{
+			++DroppedRecords;
+			return;
+		}
+	}
+
+	FString Line;
+	{
+		TSharedRef<FVivoxMetricsJsonWriter> Writer = FVivoxMetricsJsonWriter::Create(&Line);
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("session"), SessionId);
+		Writer->WriteValue(TEXT("t"), FMath::RoundToDouble((FPlatformTime::Seconds() - SessionStartTime) * 1000.0) / 1000.0);
+		Writer->WriteValue(TEXT("event"), FString(Event));
+		Fill(*Writer);
+		Writer->WriteObjectEnd();
+		Writer->Close();
+	}
+	Line.AppendChar(TEXT('\n'));
+
+	{
+		FScopeLock Lock(&QueueLock);
+		if (DroppedRecords > 0)
+		{
+			//Tell the reader records are missing before the next one
+			Queue.Add(FString::Printf(TEXT("{\"session\":\"%s\",\"event\":\"dropped\",\"count\":%d}\n"), *SessionId, DroppedRecords));
+			DroppedRecords = 0;
+		}
+		Queue.Add(MoveTemp(Line));
+	}
+	WakeEvent->Trigger();
+}
+
+void FVivoxMetricsWriter::Record(const TCHAR* Event)
+{
+	Record(Event, [](FVivoxMetricsJsonWriter&) {});
+}
+
+uint32 FVivoxMetricsWriter::Run()
+{
+	while (!bStopping)
+	{
+		//Batch records written close together into one file write
+		WakeEvent->Wait(FTimespan::FromSeconds(1.0));
+		WriteQueued();
+	}
+	WriteQueued();
+	File.Reset();
+	return 0;
+}
+
+void FVivoxMetricsWriter::Stop()
+{
+	bStopping = true;
+	if (WakeEvent != nullptr)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+FString FVivoxMetricsWriter::GetFilePath(int32 Index) const
+{
+	return Index == 0
+		? FPaths::Combine(Directory, FileName + TEXT(".ndjson"))
+		: FPaths::Combine(Directory, FString::Printf(TEXT("%s.%d.ndjson"), *FileName, Index));
+}
+
+void FVivoxMetricsWriter::WriteQueued()
+{
+	TArray<FString> Batch;
+	{
+		FScopeLock Lock(&QueueLock);
+		if (Queue.Num() == 0)
+			return;
+		Batch = MoveTemp(Queue);
+		Queue.Reset();
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!File.IsValid())
+	{
+		PlatformFile.CreateDirectoryTree(*Directory);
+		File.Reset(PlatformFile.OpenWrite(*GetFilePath(0), true, true));
+		if (!File.IsValid())
+		{
+			UE_LOG(LogVivox, Warning, TEXT("Cannot open vivox metrics file in %s , %d records dropped"), *Directory, Batch.Num());
+			return;
+		}
+	}
+
+	for (const FString& Line : Batch)
+	{
+		const FTCHARToUTF8 Utf8(*Line);
+		File->Write(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+	File->Flush();
+
+	if (File->Size() >= MaxFileBytes)
+	{
+		RotateFiles();
+	}
+}
+
+void FVivoxMetricsWriter::RotateFiles()
+{
+	File.Reset();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.DeleteFile(*GetFilePath(MaxFiles - 1));
+	for (int32 Index = MaxFiles - 2; Index >= 0; --Index)
+	{
+		const FString From = GetFilePath(Index);
+		if (PlatformFile.FileExists(*From))
+		{
+			PlatformFile.MoveFile(*GetFilePath(Index + 1), *From);
+		}
+	}
+}
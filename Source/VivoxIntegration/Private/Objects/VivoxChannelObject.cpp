@@ -8,116 +8,193 @@
 //Subsytem
 #include "Subsystem/VivoxSubSystem.h"
 //
+//Replay
+#include "Replay/VivoxEventLog.h"
+//
 #include "Kismet/KismetSystemLibrary.h"
 
 
 void UVivoxChannelObject::SetAudioConnected(bool bListenAudio, bool bTransmitAudio)
 {
+	RecordEvent(EVivoxRecordedEventType::ApiSetAudioConnected, [bListenAudio, bTransmitAudio](FVivoxRecordedEvent& Event)
+		{
+			Event.Value = (bListenAudio ? VivoxRecordedAudio_Listen : 0) | (bTransmitAudio ? VivoxRecordedAudio_Transmit : 0);
+		});
+	if (ChannelSession == nullptr && !bOfflineChannel)
+		return;
+
 	if (ChannelSession != nullptr)
 	{
 		ChannelSession->BeginSetAudioConnected(bListenAudio, bTransmitAudio);
-		bTransmittingAudio = bTransmitAudio;
-		bListeningAudio = bListenAudio;
+		//An explicit request overrides the idle suspension
+		if (bTextConnectedForSuspend && bListenAudio)
+		{
+			ChannelSession->BeginSetTextConnected(false);
+			bTextConnectedForSuspend = false;
+		}
 	}
+	bTransmittingAudio = bTransmitAudio;
+	bListeningAudio = bListenAudio;
+	bAudioIdleSuspended = false;
+	bBudgetDemoted = false;
+	LastSpeechActivityTime = FPlatformTime::Seconds();
+	MarkChannelBudgetDirty();
+}
+
+void UVivoxChannelObject::JoinChannel(FString ChannelSessionId, FOnVivoxChannelJoined OnChannelJoined,bool bConnectAudio, bool bTransmitAudio, bool bConnectText)
+{
+	JoinChannelAsync(ChannelSessionId, bConnectAudio, bTransmitAudio, bConnectText).Then([OnChannelJoined](TFuture<bool> Joined)
+		{
+			OnChannelJoined.ExecuteIfBound(Joined.Get());
+		});
 }
 
-void UVivoxChannelObject::JoinChannel(FString ChannelSessionId, EVivoxChannelType ChannelType, FOnVivoxChannelJoined OnChannelJoined,bool bConnectAudio, bool bTransmitAudio)
+TFuture<bool> UVivoxChannelObject::JoinChannelAsync(const FString& ChannelSessionId, bool bConnectAudio, bool bTransmitAudio, bool bConnectText, const FVivoxCancellationToken& CancellationToken)
 {
+	LLM_SCOPE_BYTAG(Vivox);
 	if (!(IsValid(GetOuter()) && GetOuter() != nullptr))
-		return;
+		return VivoxAsync::MakeCompleted(false);
 
 	if (!Cast<UGameInstance>(GetOuter()))
-		return;
+		return VivoxAsync::MakeCompleted(false);
 
 	UVivoxSubSystem* VivoxSubsystem = Cast<UGameInstance>(GetOuter())->GetSubsystem<UVivoxSubSystem>();
 
 	if (!(IsValid(VivoxSubsystem) && VivoxSubsystem != nullptr))
-		return;
-
-	IChannelSession::FOnBeginConnectCompletedDelegate OnConnectionComplete;
-	OnConnectionComplete.BindLambda([this, OnChannelJoined](VivoxCoreError Error)
-		{
-			OnChannelJoined.ExecuteIfBound(Error == 0);
-		});
-	VivoxSubsystem->LoginSession = &VivoxSubsystem->VivoxVoiceClient->GetLoginSession(VivoxSubsystem->LoggedInUserId);
+		return VivoxAsync::MakeCompleted(false);
 
-	ChannelId Channel;
-	UVivoxSettings* Setting = GetMutableDefault<UVivoxSettings>();
-	Channel3DProperties PosChannelProperty = Channel3DProperties(Setting->AudibleDistance, Setting->ConversationalDistance,Setting->AudioFadeIntensityByDistance,StaticCast<EAudioFadeModel>(uint8(Setting->AudioModel)));
-	UE_LOG(LogVivox,Warning,TEXT("The vivox position settings are , Audible distance %f , Convers %f , fadeInt %f."), Setting->AudibleDistance, Setting->ConversationalDistance, Setting->AudioFadeIntensityByDistance);
-	CurrentChannelType = ChannelType;
-	switch (ChannelType)
-	{
-	case EVivoxChannelType::Positional:
-
-		Channel = ChannelId(VivoxSubsystem->GetVivoxCredentials().TokenIssuer, ChannelSessionId, VivoxSubsystem->GetVivoxCredentials().Domain, ChannelType::Positional, PosChannelProperty);
-		break;
-	case EVivoxChannelType::NonPositional:
-		Channel = ChannelId(VivoxSubsystem->GetVivoxCredentials().TokenIssuer, ChannelSessionId, VivoxSubsystem->GetVivoxCredentials().Domain, ChannelType::NonPositional);
-		break;
-	case EVivoxChannelType::Echo:
-		Channel = ChannelId(VivoxSubsystem->GetVivoxCredentials().TokenIssuer, ChannelSessionId, VivoxSubsystem->GetVivoxCredentials().Domain, ChannelType::Echo);
-		break;
-	default:
-		break;
+	if (VivoxSubsystem->VivoxVoiceClient == nullptr)
+	{
+		UE_LOG(LogVivox, Error, TEXT("Vivox is not initialized cannot join channel %s"), *ChannelSessionId);
+		return VivoxAsync::MakeCompleted(false);
 	}
-	ChannelSession = &VivoxSubsystem->LoginSession->GetChannelSession(Channel);
-	FString JoinToken = ChannelSession->GetConnectToken(VivoxSubsystem->GetVivoxCredentials().TokenKey, FTimespan::FromSeconds(180));
-	ChannelSession->BeginConnect(bConnectAudio, false, bTransmitAudio, JoinToken, OnConnectionComplete);
-	
-	//No need for this in plugin here either make it somewhere else 
 
-	ChannelSession->EventAfterParticipantAdded.AddLambda([this](const IParticipant& Participant)
+	if (CancellationToken.IsCancelled())
+		return VivoxAsync::MakeCompleted(false);
+
+	TVivoxAsyncOperationRef<bool> Operation = VivoxAsync::MakeOperation<bool>();
+	IChannelSession::FOnBeginConnectCompletedDelegate OnConnectionComplete;
+	OnConnectionComplete.BindWeakLambda(this, [this, Operation](VivoxCoreError Error)
 		{
-			UE_LOG(LogTemp, Log, TEXT("Participant added: %s"),
-				*FString(Participant.Account().Name()));
+			//Cancelled , the channel was already left
+			if (Operation->IsCompleted())
+				return;
 
-			if (Participant.IsSelf())
+			RecordEvent(EVivoxRecordedEventType::ConnectCompleted, [Error](FVivoxRecordedEvent& Event)
+				{
+					Event.Value = Error;
+				});
+			//A later join may have superseded this one
+			if (PendingJoinOperation == Operation)
+			{
+				PendingJoinOperation.Reset();
+			}
+			HandleConnectCompleted(Error == 0);
+			Operation->Complete(Error == 0);
+		});
+	CancellationToken.OnCancelled(Operation, [WeakThis = TWeakObjectPtr<UVivoxChannelObject>(this), Operation]()
+		{
+			if (Operation->Complete(false) && WeakThis.IsValid())
 			{
-				UE_LOG(LogTemp, Log, TEXT("Local participant detected"));
-				CurrentParticipant = const_cast<IParticipant*>(&Participant); // store pointer for later
+				WeakThis->LeaveChannel();
 			}
 		});
+	VivoxSubsystem->LoginSession = &VivoxSubsystem->VivoxVoiceClient->GetLoginSession(VivoxSubsystem->LoggedInUserId);
+
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	ChannelId Channel = MakeChannelId(VivoxSubsystem->GetVivoxCredentials().TokenIssuer, ChannelSessionId, VivoxSubsystem->GetVivoxCredentials().Domain);
+	ChannelSession = &VivoxSubsystem->LoginSession->GetChannelSession(Channel);
+	FString JoinToken;
+	if (UVivoxSubSystem::UsesExternalTokens())
+	{
+		//Checked by the subsystem before the channel object is created
+		const FVivoxIssuedToken* IssuedToken = VivoxSubsystem->FindExternalJoinToken(GetChannelType(), ChannelSessionId);
+		JoinToken = IssuedToken ? IssuedToken->Token : FString();
+	}
+	else
+	{
+		JoinToken = ChannelSession->GetConnectToken(VivoxSubsystem->GetVivoxCredentials().TokenKey, FTimespan::FromSeconds(180));
+	}
+	bConnectPending = true;
+	bConnectFailed = false;
+	JoinStartTime = FPlatformTime::Seconds();
+	ChannelSession->BeginConnect(bConnectAudio, bConnectText, bTransmitAudio, JoinToken, OnConnectionComplete);
+	
+	BindChannelSessionEvents();
 
 	bTransmittingAudio = bTransmitAudio;
 	bListeningAudio = bConnectAudio;
+	bAudioIdleSuspended = false;
+	bBudgetDemoted = false;
+	bTextConnectedForSuspend = false;
+	bTextRequested = bConnectText;
+	if (TextHistory.GetCapacity() != Setting->TextHistoryCapacity)
+	{
+		TextHistory.SetCapacity(Setting->TextHistoryCapacity);
+	}
+	TextSendTokens = Setting->TextSendBurst;
+	LastSpeechActivityTime = FPlatformTime::Seconds();
 	CurrentChannelSessionId = ChannelSessionId;
-	
+	CurrentChannelSessionName = FName(*ChannelSessionId);
+	if (PendingJoinOperation.IsValid())
+	{
+		//Superseded by this join , failed on the next frame like the joins a teardown drops
+		VivoxSubsystem->CompleteNextTick(PendingJoinOperation.ToSharedRef(), false);
+	}
+	PendingJoinOperation = Operation;
+	return Operation->GetFuture();
 }
 
-ChannelId UVivoxChannelObject::GetChannel()
+void UVivoxChannelObject::InitializeForReplay(const FString& ChannelSessionId, bool bConnectAudio, bool bTransmitAudio, bool bConnectText)
 {
-	if (ChannelSession != nullptr)
+	LLM_SCOPE_BYTAG(Vivox);
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	bOfflineChannel = true;
+	CurrentChannelSessionId = ChannelSessionId;
+	CurrentChannelSessionName = FName(*ChannelSessionId);
+	bListeningAudio = bConnectAudio;
+	bTransmittingAudio = bTransmitAudio;
+	bTextRequested = bConnectText;
+	bConnectPending = true;
+	bConnectFailed = false;
+	JoinStartTime = FPlatformTime::Seconds();
+	TextHistory.SetCapacity(Setting->TextHistoryCapacity);
+	TextSendTokens = Setting->TextSendBurst;
+	LastSpeechActivityTime = FPlatformTime::Seconds();
+}
+
+void UVivoxChannelObject::HandleConnectCompleted(bool bSuccess)
+{
+	bConnectPending = false;
+	bConnectFailed = !bSuccess;
+	LastJoinLatencySeconds = static_cast<float>(FPlatformTime::Seconds() - JoinStartTime);
+	if (bSuccess)
 	{
-		return ChannelSession->Channel();
+		ConnectedTime = FPlatformTime::Seconds();
+	}
+	if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubsystem())
+	{
+		VivoxSubsystem->ReportChannelJoined(this, bSuccess, LastJoinLatencySeconds);
+	}
+	if (!bSuccess)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Failed to connect to channel %s"), *CurrentChannelSessionId);
 	}
-	return ChannelId();
 }
 
-ConnectionState UVivoxChannelObject::GetChannelConnectionState()
+ChannelId UVivoxChannelObject::GetChannel()
 {
 	if (ChannelSession != nullptr)
 	{
-		auto ConnState = ChannelSession->ChannelState();
-		switch (ConnState)
-		{
-		case ConnectionState::Disconnected:
-			return ConnectionState::Disconnected;
-		case ConnectionState::Connecting:
-			return ConnectionState::Connecting;
-		case ConnectionState::Connected:
-			return ConnectionState::Connected;
-		case ConnectionState::Disconnecting:
-			return ConnectionState::Disconnecting;
-		default:
-			return ConnectionState::Disconnected;
-		}
+		return ChannelSession->Channel();
 	}
-	return ConnectionState::Disconnected;
+	return ChannelId();
 }
 
 void UVivoxChannelObject::LeaveChannel()
 {
+	RecordEvent(EVivoxRecordedEventType::ApiLeaveChannel);
+
 	if (!(IsValid(GetOuter()) && GetOuter()!=nullptr))
 		return;
 
@@ -129,93 +206,662 @@ void UVivoxChannelObject::LeaveChannel()
 	if (!(IsValid(VivoxSubsystem) && VivoxSubsystem != nullptr))
 		return;
 
-	const FString* Key;
-	switch (CurrentChannelType)
+	if (TMap<FString, UVivoxChannelObject*>* Registry = VivoxSubsystem->GetChannelRegistry(GetChannelType()))
 	{
-	case EVivoxChannelType::NonPositional:
-		Key = VivoxSubsystem->NonPostionalChannels.FindKey(this);
-		if (Key)
+		if (Registry->FindRef(CurrentChannelSessionId) == this)
 		{
-			VivoxSubsystem->NonPostionalChannels.Remove(*Key);
+			Registry->Remove(CurrentChannelSessionId);
 		}
-		break;
-	case EVivoxChannelType::Positional:
-		Key = VivoxSubsystem->PositionalChannels.FindKey(this);
-		if (Key)
-		{
-			VivoxSubsystem->PositionalChannels.Remove(*Key);
-		}
-		break;
-	case EVivoxChannelType::Echo:
-		Key = VivoxSubsystem->EchoChannels.FindKey(this);
-		if (Key)
+	}
+
+	ShutdownChannel();
+	VivoxSubsystem->MarkChannelBudgetDirty();
+
+	UKismetSystemLibrary::CollectGarbage();
+}
+
+TFuture<bool> UVivoxChannelObject::LeaveChannelAsync()
+{
+	TVivoxAsyncOperationRef<bool> Operation = VivoxAsync::MakeOperation<bool>();
+	PendingLeaveOperation = Operation;
+	LeaveChannel();
+	//Still set when LeaveChannel found no subsystem and left nothing
+	if (PendingLeaveOperation.IsValid())
+	{
+		PendingLeaveOperation.Reset();
+		Operation->Complete(false);
+	}
+	return Operation->GetFuture();
+}
+
+//Completes Operation on the next Disconnected state of Session , the object may be collected before that so nothing of it is captured
+static void CompleteOnDisconnected(IChannelSession& Session, const TVivoxAsyncOperationRef<bool>& Operation)
+{
+	TSharedRef<FDelegateHandle> Handle = MakeShared<FDelegateHandle>();
+	IChannelSession* SessionPtr = &Session;
+	*Handle = Session.EventChannelStateChanged.AddLambda([SessionPtr, Handle, Operation](const IChannelConnectionState& State)
 		{
-			VivoxSubsystem->EchoChannels.Remove(*Key);
-		}
-		break;
-	default:
-		break;
+			if (State.State() != ConnectionState::Disconnected)
+				return;
+
+			SessionPtr->EventChannelStateChanged.Remove(*Handle);
+			Operation->Complete(true);
+		});
+}
+
+void UVivoxChannelObject::ShutdownChannel()
+{
+	UVivoxSubSystem* VivoxSubsystem = GetVivoxSubsystem();
+	if (VivoxSubsystem != nullptr)
+	{
+		VivoxSubsystem->ReportChannelLeft(this, ConnectedTime > 0.0 ? FPlatformTime::Seconds() - ConnectedTime : 0.0, PeakParticipants);
 	}
 
+	TSharedPtr<TVivoxAsyncOperation<bool>> LeaveOperation = MoveTemp(PendingLeaveOperation);
+	PendingLeaveOperation.Reset();
 	if (ChannelSession != nullptr)
 	{
+		UnbindChannelSessionEvents();
+		//A session that is already disconnected sends no more state events
+		if (LeaveOperation.IsValid() && ChannelSession->ChannelState() != ConnectionState::Disconnected)
+		{
+			CompleteOnDisconnected(*ChannelSession, LeaveOperation.ToSharedRef());
+			if (VivoxSubsystem != nullptr)
+			{
+				VivoxSubsystem->TrackLeaveOperation(LeaveOperation.ToSharedRef());
+			}
+			LeaveOperation.Reset();
+		}
 		ChannelSession->Disconnect(false);
 		ChannelSession = nullptr;
 	}
+	if (LeaveOperation.IsValid())
+	{
+		if (VivoxSubsystem != nullptr)
+		{
+			VivoxSubsystem->CompleteNextTick(LeaveOperation.ToSharedRef(), true);
+		}
+		else
+		{
+			LeaveOperation->Complete(true);
+		}
+	}
+	ResetConnectionStates();
+	CurrentParticipant = nullptr;
+	bConnectPending = false;
+	if (PendingJoinOperation.IsValid())
+	{
+		//Failed on the next frame , continuations must not run in the middle of a bulk teardown
+		if (VivoxSubsystem != nullptr)
+		{
+			VivoxSubsystem->CompleteNextTick(PendingJoinOperation.ToSharedRef(), false);
+		}
+		else
+		{
+			PendingJoinOperation->Complete(false);
+		}
+		PendingJoinOperation.Reset();
+	}
+	Participants.Empty();
+	OutboundTextQueue.Empty();
+	PendingInboundMessages.Empty();
+	TextHistory.SetCapacity(0);
 
 	this->MarkAsGarbage();
-	UKismetSystemLibrary::CollectGarbage();
 }
 
-//Vivox 3d position
+//Channel session events
+
+void UVivoxChannelObject::BindChannelSessionEvents()
+{
+	if (ChannelSession == nullptr)
+		return;
+
+	//Joining again returns the same channel session so drop the old bindings first
+	UnbindChannelSessionEvents();
+	TextMessageReceivedHandle = ChannelSession->EventTextMessageReceived.AddUObject(this, &UVivoxChannelObject::OnTextMessageReceived);
+	ParticipantAddedHandle = ChannelSession->EventAfterParticipantAdded.AddUObject(this, &UVivoxChannelObject::OnParticipantAdded);
+	ParticipantUpdatedHandle = ChannelSession->EventAfterParticipantUpdated.AddUObject(this, &UVivoxChannelObject::OnParticipantUpdated);
+	ParticipantRemovedHandle = ChannelSession->EventBeforeParticipantRemoved.AddUObject(this, &UVivoxChannelObject::OnParticipantRemoved);
+	ChannelStateChangedHandle = ChannelSession->EventChannelStateChanged.AddUObject(this, &UVivoxChannelObject::OnSessionChannelStateChanged);
+	AudioStateChangedHandle = ChannelSession->EventAudioStateChanged.AddUObject(this, &UVivoxChannelObject::OnSessionAudioStateChanged);
+	TextStateChangedHandle = ChannelSession->EventTextStateChanged.AddUObject(this, &UVivoxChannelObject::OnSessionTextStateChanged);
 
-bool UVivoxChannelObject::Get3DValuesAreDirty() const
+	//Seed the cache once , from here on it only changes through the events
+	HandleChannelStateChanged(ChannelSession->ChannelState());
+	HandleAudioStateChanged(ChannelSession->AudioState());
+	HandleTextStateChanged(ChannelSession->TextState());
+}
+
+void UVivoxChannelObject::UnbindChannelSessionEvents()
 {
-	return (CachedPosition.IsDirty() || CachedForwardVector.IsDirty() || CachedUpVector.IsDirty());
+	if (ChannelSession == nullptr)
+		return;
+
+	ChannelSession->EventTextMessageReceived.Remove(TextMessageReceivedHandle);
+	ChannelSession->EventAfterParticipantAdded.Remove(ParticipantAddedHandle);
+	ChannelSession->EventAfterParticipantUpdated.Remove(ParticipantUpdatedHandle);
+	ChannelSession->EventBeforeParticipantRemoved.Remove(ParticipantRemovedHandle);
+	ChannelSession->EventChannelStateChanged.Remove(ChannelStateChangedHandle);
+	ChannelSession->EventAudioStateChanged.Remove(AudioStateChangedHandle);
+	ChannelSession->EventTextStateChanged.Remove(TextStateChangedHandle);
+	TextMessageReceivedHandle.Reset();
+	ParticipantAddedHandle.Reset();
+	ParticipantUpdatedHandle.Reset();
+	ParticipantRemovedHandle.Reset();
+	ChannelStateChangedHandle.Reset();
+	AudioStateChangedHandle.Reset();
+	TextStateChangedHandle.Reset();
 }
 
-void UVivoxChannelObject::Clear3DValuesAreDirty()
+static FVivoxParticipantState MakeParticipantState(const IParticipant& Participant)
 {
-	CachedPosition.SetDirty(false);
-	CachedForwardVector.SetDirty(false);
-	CachedUpVector.SetDirty(false);
+	FVivoxParticipantState State;
+	State.ParticipantId = Participant.ParticipantId();
+	State.AccountName = Participant.Account().Name();
+	State.DisplayName = Participant.Account().DisplayName();
+	State.bIsSelf = Participant.IsSelf();
+	State.bInAudio = Participant.InAudio();
+	State.bSpeechDetected = Participant.SpeechDetected();
+	State.AudioEnergy = Participant.AudioEnergy();
+	return State;
 }
 
-void UVivoxChannelObject::UpdateVivox3dPosition(const FVector& position, const FVector& ForwardVector, const FVector& UpVector)
+void UVivoxChannelObject::OnParticipantAdded(const IParticipant& Participant)
 {
-	if (ChannelSession != nullptr)
+	LLM_SCOPE_BYTAG(Vivox);
+	if (Participant.IsSelf())
 	{
-	 	auto AudioState = ChannelSession->AudioState();
-		switch (AudioState)
+		CurrentParticipant = const_cast<IParticipant*>(&Participant); // store pointer for later
+	}
+	const FVivoxParticipantState State = MakeParticipantState(Participant);
+	RecordEvent(EVivoxRecordedEventType::ParticipantAdded, [&State](FVivoxRecordedEvent& Event)
 		{
-		case ConnectionState::Disconnected:
-			UE_LOG(LogVivox, Warning, TEXT("Audio is not connected , cannot change position of speaker in 3d space"));
-			break;
-		case ConnectionState::Connecting:
-			UE_LOG(LogVivox, Warning, TEXT("Audio is connecting , cannot change 3d postion for now"));
-			break;
-		case ConnectionState::Connected:
-			CachedPosition.SetValue(position);
-			CachedForwardVector.SetValue(ForwardVector);
-			CachedUpVector.SetValue(UpVector);
-			if (!Get3DValuesAreDirty())
-				return;
-			ChannelSession->Set3DPosition(CachedPosition.GetValue(), CachedPosition.GetValue(), CachedForwardVector.GetValue(), CachedUpVector.GetValue());
-			Clear3DValuesAreDirty();
-			break;
-		case ConnectionState::Disconnecting:
-			UE_LOG(LogVivox, Warning, TEXT("Cannot change 3d position the audio is disconnecting"));
-			break;
-		default:
+			Event.Participant = State;
+		});
+	HandleParticipantAdded(State);
+}
+
+void UVivoxChannelObject::OnParticipantUpdated(const IParticipant& Participant)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	const FVivoxParticipantState State = MakeParticipantState(Participant);
+	RecordEvent(EVivoxRecordedEventType::ParticipantUpdated, [&State](FVivoxRecordedEvent& Event)
+		{
+			Event.Participant = State;
+		});
+	HandleParticipantUpdated(State);
+}
+
+void UVivoxChannelObject::OnParticipantRemoved(const IParticipant& Participant)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	if (CurrentParticipant == &Participant)
+	{
+		CurrentParticipant = nullptr;
+	}
+	const FVivoxParticipantState State = MakeParticipantState(Participant);
+	RecordEvent(EVivoxRecordedEventType::ParticipantRemoved, [&State](FVivoxRecordedEvent& Event)
+		{
+			Event.Participant = State;
+		});
+	HandleParticipantRemoved(State);
+}
+
+//Connection state
+
+void UVivoxChannelObject::OnSessionChannelStateChanged(const IChannelConnectionState& State)
+{
+	const ConnectionState NewState = State.State();
+	RecordEvent(EVivoxRecordedEventType::ChannelStateChanged, [NewState](FVivoxRecordedEvent& Event)
+		{
+			Event.Value = static_cast<int32>(NewState);
+		});
+	HandleChannelStateChanged(NewState);
+}
+
+void UVivoxChannelObject::OnSessionAudioStateChanged(const IChannelConnectionState& State)
+{
+	const ConnectionState NewState = State.State();
+	RecordEvent(EVivoxRecordedEventType::AudioStateChanged, [NewState](FVivoxRecordedEvent& Event)
+		{
+			Event.Value = static_cast<int32>(NewState);
+		});
+	HandleAudioStateChanged(NewState);
+}
+
+void UVivoxChannelObject::OnSessionTextStateChanged(const IChannelConnectionState& State)
+{
+	const ConnectionState NewState = State.State();
+	RecordEvent(EVivoxRecordedEventType::TextStateChanged, [NewState](FVivoxRecordedEvent& Event)
+		{
+			Event.Value = static_cast<int32>(NewState);
+		});
+	HandleTextStateChanged(NewState);
+}
+
+void UVivoxChannelObject::HandleChannelStateChanged(ConnectionState State)
+{
+	if (CachedChannelState == State)
+		return;
+
+	//The sdk goes back to connecting when it reconnects a dropped channel
+	if (CachedChannelState == ConnectionState::Connected && State == ConnectionState::Connecting)
+	{
+		if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubsystem())
+		{
+			VivoxSubsystem->ReportChannelReconnecting(this);
+		}
+	}
+
+	CachedChannelState = State;
+	if (State == ConnectionState::Disconnected)
+	{
+		//A dropped desired channel is joined again by the reconciler
+		if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubsystem())
+		{
+			VivoxSubsystem->MarkDesiredChannelsDirty();
+		}
+	}
+	OnChannelStateChanged.Broadcast(this, State);
+}
+
+void UVivoxChannelObject::HandleAudioStateChanged(ConnectionState State)
+{
+	if (CachedAudioState == State)
+		return;
+
+	CachedAudioState = State;
+	OnAudioStateChanged.Broadcast(this, State);
+}
+
+void UVivoxChannelObject::HandleTextStateChanged(ConnectionState State)
+{
+	if (CachedTextState == State)
+		return;
+
+	CachedTextState = State;
+	OnTextStateChanged.Broadcast(this, State);
+}
+
+void UVivoxChannelObject::ResetConnectionStates()
+{
+	CachedChannelState = ConnectionState::Disconnected;
+	CachedAudioState = ConnectionState::Disconnected;
+	CachedTextState = ConnectionState::Disconnected;
+}
+
+//Roster
+
+void UVivoxChannelObject::HandleParticipantAdded(const FVivoxParticipantState& Participant)
+{
+	UE_LOG(LogVivox, Log, TEXT("Participant added to %s: %s"), *CurrentChannelSessionId, *Participant.AccountName);
+	FVivoxParticipantState& Entry = Participants.Add(Participant.ParticipantId, Participant);
+	Entry.SnapshotParticipantId = FName(*Participant.ParticipantId);
+	Entry.SnapshotAccountName = FName(*Participant.AccountName);
+	PeakParticipants = FMath::Max(PeakParticipants, Participants.Num());
+
+	//Roster events keep coming through the text connection , someone joining is likely to talk
+	if (bAudioIdleSuspended && !Participant.bIsSelf)
+	{
+		WakeFromIdle();
+	}
+}
+
+void UVivoxChannelObject::HandleParticipantUpdated(const FVivoxParticipantState& Participant)
+{
+	FVivoxParticipantState& Entry = Participants.FindOrAdd(Participant.ParticipantId);
+	const bool bStartedSpeaking = Participant.bSpeechDetected && !Entry.bSpeechDetected;
+	//Updates do not carry the snapshot names , they are kept from the added entry
+	const FName SnapshotParticipantId = Entry.SnapshotParticipantId.IsNone() ? FName(*Participant.ParticipantId) : Entry.SnapshotParticipantId;
+	const FName SnapshotAccountName = Entry.SnapshotAccountName.IsNone() ? FName(*Participant.AccountName) : Entry.SnapshotAccountName;
+	Entry = Participant;
+	Entry.SnapshotParticipantId = SnapshotParticipantId;
+	Entry.SnapshotAccountName = SnapshotAccountName;
+
+	//Only reported while audio is connected , a suspended channel hears speech during its recheck window
+	if (bStartedSpeaking)
+	{
+		LastSpeechActivityTime = FPlatformTime::Seconds();
+	}
+
+	OnParticipantUpdated(Participant);
+}
+
+void UVivoxChannelObject::HandleParticipantRemoved(const FVivoxParticipantState& Participant)
+{
+	UE_LOG(LogVivox, Log, TEXT("Participant removed from %s: %s"), *CurrentChannelSessionId, *Participant.AccountName);
+	Participants.Remove(Participant.ParticipantId);
+}
+
+TArray<FVivoxParticipantState> UVivoxChannelObject::GetParticipants() const
+{
+	TArray<FVivoxParticipantState> ParticipantArray;
+	Participants.GenerateValueArray(ParticipantArray);
+	return ParticipantArray;
+}
+
+//Idle audio suspension
+
+void UVivoxChannelObject::SetIdleAudioSuspendEnabled(bool bEnabled)
+{
+	bIdleSuspendEnabled = bEnabled;
+	if (!bEnabled && bAudioIdleSuspended)
+	{
+		ResumeAudioFromIdle();
+	}
+}
+
+void UVivoxChannelObject::WakeFromIdle()
+{
+	LastSpeechActivityTime = FPlatformTime::Seconds();
+	if (bAudioIdleSuspended)
+	{
+		ResumeAudioFromIdle();
+	}
+}
+
+bool UVivoxChannelObject::CanIdleSuspend() const
+{
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	if (!Setting->bEnableIdleAudioSuspend || !bIdleSuspendEnabled)
+		return false;
+
+	if (!SupportsIdleSuspend() || ChannelSession == nullptr)
+		return false;
+
+	if (!bListeningAudio || (bTransmittingAudio && !Setting->bIdleSuspendTransmittingChannels))
+		return false;
+
+	return CachedChannelState == ConnectionState::Connected && CachedAudioState == ConnectionState::Connected;
+}
+
+void UVivoxChannelObject::DisconnectAudioKeepText()
+{
+	if (ChannelSession == nullptr)
+		return;
+
+	//The channel is left when both audio and text are gone so keep text connected while audio is dropped
+	if (CachedTextState == ConnectionState::Disconnected)
+	{
+		ChannelSession->BeginSetTextConnected(true);
+		bTextConnectedForSuspend = true;
+	}
+	ChannelSession->BeginSetAudioConnected(false, false);
+}
+
+void UVivoxChannelObject::ReconnectAudio()
+{
+	if (ChannelSession == nullptr)
+		return;
+
+	IChannelSession::FOnBeginSetAudioConnectedCompletedDelegate OnAudioResumed;
+	OnAudioResumed.BindWeakLambda(this, [this](VivoxCoreError Error)
+		{
+			if (Error == 0 && bTextConnectedForSuspend && ChannelSession != nullptr)
+			{
+				ChannelSession->BeginSetTextConnected(false);
+				bTextConnectedForSuspend = false;
+			}
+		});
+	ChannelSession->BeginSetAudioConnected(bListeningAudio, bTransmittingAudio, OnAudioResumed);
+}
+
+void UVivoxChannelObject::SuspendAudioForIdle()
+{
+	bAudioIdleSuspended = true;
+	IdleSuspendedTime = FPlatformTime::Seconds();
+	if (!bBudgetDemoted)
+	{
+		DisconnectAudioKeepText();
+	}
+	UE_LOG(LogVivox, Log, TEXT("Suspended audio of idle channel %s"), *CurrentChannelSessionId);
+	MarkChannelBudgetDirty();
+}
+
+void UVivoxChannelObject::ResumeAudioFromIdle()
+{
+	bAudioIdleSuspended = false;
+	if (!bBudgetDemoted)
+	{
+		ReconnectAudio();
+	}
+	UE_LOG(LogVivox, Log, TEXT("Resumed audio of channel %s"), *CurrentChannelSessionId);
+	MarkChannelBudgetDirty();
+}
+
+void UVivoxChannelObject::TickChannel(float DeltaTime)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	FlushOutboundText(DeltaTime);
+
+	if (PendingInboundMessages.Num() > 0)
+	{
+		//Swap out first so handlers can send or receive without touching the batch being delivered
+		TArray<FVivoxTextMessage> Batch = MoveTemp(PendingInboundMessages);
+		PendingInboundMessages.Reset();
+		OnTextMessagesReceived.Broadcast(Batch);
+	}
+
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	const double Now = FPlatformTime::Seconds();
+	if (!bAudioIdleSuspended && CanIdleSuspend())
+	{
+		if (Now - LastSpeechActivityTime >= Setting->IdleAudioSuspendSeconds)
+		{
+			SuspendAudioForIdle();
+		}
+	}
+	else if (bAudioIdleSuspended && Setting->IdleSuspendRecheckSeconds > 0.0f && Now - IdleSuspendedTime >= Setting->IdleSuspendRecheckSeconds)
+	{
+		//Listens for a short window , speech in it keeps the audio and silence suspends it again
+		LastSpeechActivityTime = Now - Setting->IdleAudioSuspendSeconds + Setting->IdleSuspendRecheckListenSeconds;
+		ResumeAudioFromIdle();
+	}
+}
+
+//Text
+
+void UVivoxChannelObject::SetTextConnected(bool bConnectText)
+{
+	if (ChannelSession == nullptr)
+	{
+		UE_LOG(LogVivox, Error, TEXT("Channel Session is not valid cannot change text state"));
+		return;
+	}
+
+	bTextRequested = bConnectText;
+	if (bTextConnectedForSuspend)
+	{
+		//Text is already up for a suspended audio channel, only change who owns it
+		bTextConnectedForSuspend = !bConnectText;
+		return;
+	}
+	ChannelSession->BeginSetTextConnected(bConnectText);
+}
+
+void UVivoxChannelObject::SendTextMessage(const FString& Message)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	if (Message.IsEmpty())
+		return;
+
+	if (!bTextRequested)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Text is not connected for channel %s , message will be sent once SetTextConnected is called"), *CurrentChannelSessionId);
+	}
+
+	//Macro or spam input repeating the last queued line is collapsed into it
+	if (OutboundTextQueue.Num() > 0 && OutboundTextQueue.Last() == Message)
+		return;
+
+	if (OutboundTextQueue.Num() >= Setting->MaxQueuedTextMessages)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Text queue of channel %s is full, message dropped"), *CurrentChannelSessionId);
+		return;
+	}
+	OutboundTextQueue.Add(Message.Left(Setting->MaxTextMessageLength));
+}
+
+void UVivoxChannelObject::FlushOutboundText(float DeltaTime)
+{
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	TextSendTokens = FMath::Min(TextSendTokens + DeltaTime * Setting->MaxTextSendsPerSecond, static_cast<float>(Setting->TextSendBurst));
+
+	if (OutboundTextQueue.Num() == 0 || bTextSendInFlight || TextSendTokens < 1.0f)
+		return;
+
+	if (ChannelSession == nullptr || CachedTextState != ConnectionState::Connected)
+		return;
+
+	//Merge as many queued lines as fit in one message so a backlog costs a single send
+	FString Coalesced = OutboundTextQueue[0];
+	int32 Merged = 1;
+	for (; Merged < OutboundTextQueue.Num(); ++Merged)
+	{
+		const FString& Next = OutboundTextQueue[Merged];
+		if (Coalesced.Len() + 1 + Next.Len() > Setting->MaxTextMessageLength)
 			break;
-		}	
+		Coalesced += TEXT("\n");
+		Coalesced += Next;
 	}
-	else
+	OutboundTextQueue.RemoveAt(0, Merged);
+
+	TextSendTokens -= 1.0f;
+	bTextSendInFlight = true;
+	IChannelSession::FOnBeginSendTextCompletedDelegate OnSendCompleted;
+	OnSendCompleted.BindWeakLambda(this, [this](VivoxCoreError Error)
+		{
+			bTextSendInFlight = false;
+			if (Error != 0)
+			{
+				UE_LOG(LogVivox, Warning, TEXT("Failed to send text message to channel %s , error %d"), *CurrentChannelSessionId, Error);
+			}
+		});
+	ChannelSession->BeginSendText(Coalesced, OnSendCompleted);
+}
+
+void UVivoxChannelObject::OnTextMessageReceived(const IChannelTextMessage& TextMessage)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	FVivoxTextMessage Message;
+	Message.SenderAccountName = TextMessage.Sender().Name();
+	Message.SenderDisplayName = TextMessage.Sender().DisplayName();
+	Message.Message = TextMessage.Message();
+	Message.ReceivedTime = TextMessage.ReceivedTime();
+	RecordEvent(EVivoxRecordedEventType::TextMessageReceived, [&Message](FVivoxRecordedEvent& Event)
+		{
+			Event.Name = Message.SenderAccountName;
+			Event.Text = Message.Message;
+		});
+	HandleTextMessageReceived(Message);
+}
+
+void UVivoxChannelObject::HandleTextMessageReceived(const FVivoxTextMessage& TextMessage)
+{
+	TextHistory.Add(TextMessage);
+	PendingInboundMessages.Add(TextMessage);
+
+	//Text stays connected while audio is suspended , a chatting channel is active
+	if (bAudioIdleSuspended)
+	{
+		WakeFromIdle();
+	}
+}
+
+TArray<FVivoxTextMessage> UVivoxChannelObject::GetTextHistory() const
+{
+	return TextHistory.ToArray();
+}
+
+//Channel budget
+
+void UVivoxChannelObject::SetChannelPriority(int32 NewPriority)
+{
+	if (Priority != NewPriority)
+	{
+		Priority = NewPriority;
+		MarkChannelBudgetDirty();
+	}
+}
+
+bool UVivoxChannelObject::WantsAudioBudget() const
+{
+	return ChannelSession != nullptr && bListeningAudio && !bAudioIdleSuspended;
+}
+
+bool UVivoxChannelObject::UsesAudioBudget() const
+{
+	return WantsAudioBudget() && !bBudgetDemoted;
+}
+
+void UVivoxChannelObject::DemoteForBudget()
+{
+	if (bBudgetDemoted)
+		return;
+
+	bBudgetDemoted = true;
+	if (!bAudioIdleSuspended)
+	{
+		DisconnectAudioKeepText();
+	}
+	UE_LOG(LogVivox, Log, TEXT("Channel %s demoted to text only, audio channel budget exceeded"), *CurrentChannelSessionId);
+}
+
+void UVivoxChannelObject::PromoteFromBudget()
+{
+	if (!bBudgetDemoted)
+		return;
+
+	bBudgetDemoted = false;
+	if (!bAudioIdleSuspended)
+	{
+		ReconnectAudio();
+	}
+	UE_LOG(LogVivox, Log, TEXT("Channel %s promoted back to audio"), *CurrentChannelSessionId);
+}
+
+UVivoxSubSystem* UVivoxChannelObject::GetVivoxSubsystem() const
+{
+	const UGameInstance* GameInstance = Cast<UGameInstance>(GetOuter());
+	return IsValid(GameInstance) ? GameInstance->GetSubsystem<UVivoxSubSystem>() : nullptr;
+}
+
+void UVivoxChannelObject::MarkChannelBudgetDirty() const
+{
+	if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubsystem())
 	{
-		UE_LOG(LogVivox, Error, TEXT("Channel Session is not valid cannot change position"));
+		VivoxSubsystem->MarkChannelBudgetDirty();
 	}
 }
 
+void UVivoxChannelObject::RecordEvent(EVivoxRecordedEventType Type, TFunctionRef<void(FVivoxRecordedEvent&)> Fill) const
+{
+	UVivoxSubSystem* VivoxSubsystem = GetVivoxSubsystem();
+	if (VivoxSubsystem == nullptr || !VivoxSubsystem->IsRecordingEvents())
+		return;
+
+	FVivoxRecordedEvent Event;
+	Event.Type = Type;
+	Event.ChannelType = GetChannelType();
+	Event.ChannelSessionId = CurrentChannelSessionId;
+	Fill(Event);
+	VivoxSubsystem->RecordEvent(Event);
+}
+
+void UVivoxChannelObject::RecordEvent(EVivoxRecordedEventType Type) const
+{
+	RecordEvent(Type, [](FVivoxRecordedEvent&) {});
+}
+
+//Vivox 3d position
+
+void UVivoxChannelObject::UpdateVivox3dPosition(const FVector& position, const FVector& ForwardVector, const FVector& UpVector)
+{
+	UE_LOG(LogVivox, Warning, TEXT("Channel %s is not a positional channel , cannot change position"), *CurrentChannelSessionId);
+}
+
 bool UVivoxChannelObject::IsSpeakingToChannel(double& AudioEnergy) const
 {
 	if (CurrentParticipant != nullptr)
@@ -227,3 +873,42 @@ bool UVivoxChannelObject::IsSpeakingToChannel(double& AudioEnergy) const
 	return false;
 }
 
+//Memory
+
+static SIZE_T GetTextMessageAllocatedSize(const FVivoxTextMessage& Message)
+{
+	return Message.SenderAccountName.GetAllocatedSize() + Message.SenderDisplayName.GetAllocatedSize() + Message.Message.GetAllocatedSize();
+}
+
+void UVivoxChannelObject::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T Size = CurrentChannelSessionId.GetAllocatedSize();
+
+	Size += Participants.GetAllocatedSize();
+	for (const TPair<FString, FVivoxParticipantState>& Pair : Participants)
+	{
+		Size += Pair.Key.GetAllocatedSize() + Pair.Value.ParticipantId.GetAllocatedSize() + Pair.Value.AccountName.GetAllocatedSize() + Pair.Value.DisplayName.GetAllocatedSize();
+	}
+
+	Size += TextHistory.GetAllocatedSize();
+	TextHistory.ForEach([&Size](const FVivoxTextMessage& Message)
+		{
+			Size += GetTextMessageAllocatedSize(Message);
+		});
+
+	Size += PendingInboundMessages.GetAllocatedSize();
+	for (const FVivoxTextMessage& Message : PendingInboundMessages)
+	{
+		Size += GetTextMessageAllocatedSize(Message);
+	}
+
+	Size += OutboundTextQueue.GetAllocatedSize();
+	for (const FString& Message : OutboundTextQueue)
+	{
+		Size += Message.GetAllocatedSize();
+	}
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Size);
+}
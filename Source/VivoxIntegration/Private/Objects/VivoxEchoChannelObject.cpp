@@ -0,0 +1,85 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Objects/VivoxEchoChannelObject.h"
+//VivoxSettings
+#include "VivoxSettings.h"
+//
+
+ChannelId UVivoxEchoChannelObject::MakeChannelId(const FString& TokenIssuer, const FString& ChannelSessionId, const FString& Domain) const
+{
+	return ChannelId(TokenIssuer, ChannelSessionId, Domain, ChannelType::Echo);
+}
+
+//Self test
+
+void UVivoxEchoChannelObject::StartProbe(bool bUseLoopback)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	const double Now = FPlatformTime::Seconds();
+
+	Probe = MakeUnique<FVivoxEchoProbe>(Setting->SelfTestReturnEnergyThreshold, Setting->SelfTestClipEnergy, Setting->SelfTestMaxRoundTripSeconds);
+	if (bUseLoopback)
+	{
+		Loopback = MakeUnique<FVivoxLoopbackEchoSource>(this, Setting->LoopbackLatencyMs / 1000.0f, Setting->LoopbackJitterMs / 1000.0f);
+		Loopback->Start(Now);
+	}
+}
+
+void UVivoxEchoChannelObject::StopProbe()
+{
+	Loopback.Reset();
+	Probe.Reset();
+}
+
+FVivoxSelfTestResult UVivoxEchoChannelObject::GetProbeResult() const
+{
+	FVivoxSelfTestResult Result;
+	if (Probe.IsValid())
+	{
+		Result = Probe->GetResult(FPlatformTime::Seconds());
+	}
+	Result.bLoopback = Loopback.IsValid();
+	return Result;
+}
+
+void UVivoxEchoChannelObject::OnParticipantUpdated(const FVivoxParticipantState& Participant)
+{
+	if (!Probe.IsValid())
+		return;
+
+	//An echo channel only has the self participant , the speech and its echo are both read from it
+	if (Participant.bIsSelf)
+	{
+		Probe->AddSelfSample(FPlatformTime::Seconds(), Participant.bSpeechDetected, Participant.AudioEnergy);
+	}
+}
+
+void UVivoxEchoChannelObject::TickChannel(float DeltaTime)
+{
+	Super::TickChannel(DeltaTime);
+
+	if (Loopback.IsValid())
+	{
+		Loopback->Tick(FPlatformTime::Seconds());
+	}
+	if (Probe.IsValid())
+	{
+		Probe->ExpirePendingOnsets(FPlatformTime::Seconds());
+	}
+}
+
+void UVivoxEchoChannelObject::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	if (Probe.IsValid())
+	{
+		CumulativeResourceSize.AddDedicatedSystemMemoryBytes(sizeof(FVivoxEchoProbe) + Probe->GetAllocatedSize());
+	}
+	if (Loopback.IsValid())
+	{
+		CumulativeResourceSize.AddDedicatedSystemMemoryBytes(sizeof(FVivoxLoopbackEchoSource) + Loopback->GetAllocatedSize());
+	}
+}
@@ -0,0 +1,9 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Objects/VivoxNonPositionalChannelObject.h"
+
+ChannelId UVivoxNonPositionalChannelObject::MakeChannelId(const FString& TokenIssuer, const FString& ChannelSessionId, const FString& Domain) const
+{
+	return ChannelId(TokenIssuer, ChannelSessionId, Domain, ChannelType::NonPositional);
+}
@@ -0,0 +1,289 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Objects/VivoxPositionalChannelObject.h"
+//VivoxSettings
+#include "VivoxSettings.h"
+//
+//Replay
+#include "Replay/VivoxEventLog.h"
+//
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+ChannelId UVivoxPositionalChannelObject::MakeChannelId(const FString& TokenIssuer, const FString& ChannelSessionId, const FString& Domain) const
+{
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	Channel3DProperties PosChannelProperty = MakeChannel3DProperties();
+	UE_LOG(LogVivox,Warning,TEXT("The vivox position settings are , Audible distance %f , Convers %f , fadeInt %f."), Setting->AudibleDistance, Setting->ConversationalDistance, Setting->AudioFadeIntensityByDistance);
+	return ChannelId(TokenIssuer, ChannelSessionId, Domain, ChannelType::Positional, PosChannelProperty);
+}
+
+Channel3DProperties UVivoxPositionalChannelObject::MakeChannel3DProperties()
+{
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	//The settings enum starts at 0 , the sdk one at 1 , mapped by name so they cannot drift
+	EAudioFadeModel FadeModel = EAudioFadeModel::InverseByDistance;
+	switch (Setting->AudioModel)
+	{
+	case EVivoxAudioFadeModel::LinearByDistance:
+		FadeModel = EAudioFadeModel::LinearByDistance;
+		break;
+	case EVivoxAudioFadeModel::ExponentialByDistance:
+		FadeModel = EAudioFadeModel::ExponentialByDistance;
+		break;
+	case EVivoxAudioFadeModel::InverseByDistance:
+	default:
+		break;
+	}
+	return Channel3DProperties(Setting->AudibleDistance, Setting->ConversationalDistance, Setting->AudioFadeIntensityByDistance, FadeModel);
+}
+
+//Vivox 3d position
+
+bool UVivoxPositionalChannelObject::Get3DValuesAreDirty() const
+{
+	return (CachedPosition.IsDirty() || CachedForwardVector.IsDirty() || CachedUpVector.IsDirty());
+}
+
+void UVivoxPositionalChannelObject::Clear3DValuesAreDirty()
+{
+	CachedPosition.SetDirty(false);
+	CachedForwardVector.SetDirty(false);
+	CachedUpVector.SetDirty(false);
+}
+
+void UVivoxPositionalChannelObject::UpdateVivox3dPosition(const FVector& position, const FVector& ForwardVector, const FVector& UpVector)
+{
+	RecordEvent(EVivoxRecordedEventType::ApiUpdate3dPosition, [&](FVivoxRecordedEvent& Event)
+		{
+			Event.Position = position;
+			Event.ForwardVector = ForwardVector;
+			Event.UpVector = UpVector;
+		});
+
+	//Offline channels run the same caching and rate counting without sending to the sdk
+	if (ChannelSession != nullptr || IsOfflineChannel())
+	{
+		switch (GetAudioConnectionState())
+		{
+		case ConnectionState::Disconnected:
+			UE_LOG(LogVivox, Warning, TEXT("Audio is not connected , cannot change position of speaker in 3d space"));
+			break;
+		case ConnectionState::Connecting:
+			UE_LOG(LogVivox, Warning, TEXT("Audio is connecting , cannot change 3d postion for now"));
+			break;
+		case ConnectionState::Connected:
+			CachedPosition.SetValue(position);
+			CachedForwardVector.SetValue(ForwardVector);
+			CachedUpVector.SetValue(UpVector);
+			if (!Get3DValuesAreDirty())
+				return;
+			if (ChannelSession != nullptr)
+			{
+				ChannelSession->Set3DPosition(CachedPosition.GetValue(), CachedPosition.GetValue(), CachedForwardVector.GetValue(), CachedUpVector.GetValue());
+			}
+			Clear3DValuesAreDirty();
+			++PositionUpdatesInWindow;
+			break;
+		case ConnectionState::Disconnecting:
+			UE_LOG(LogVivox, Warning, TEXT("Cannot change 3d position the audio is disconnecting"));
+			break;
+		default:
+			break;
+		}	
+	}
+	else
+	{
+		UE_LOG(LogVivox, Error, TEXT("Channel Session is not valid cannot change position"));
+	}
+}
+
+void UVivoxPositionalChannelObject::TickChannel(float DeltaTime)
+{
+	Super::TickChannel(DeltaTime);
+	LLM_SCOPE_BYTAG(Vivox);
+
+	const double Now = FPlatformTime::Seconds();
+	const double WindowLength = Now - PositionUpdateWindowStart;
+	if (WindowLength >= 1.0)
+	{
+		PositionUpdateRate = PositionUpdateWindowStart > 0.0 ? static_cast<float>(PositionUpdatesInWindow / WindowLength) : 0.0f;
+		PositionUpdatesInWindow = 0;
+		PositionUpdateWindowStart = Now;
+	}
+
+	if (OcclusionEntries.Num() > 0 && GetDefault<UVivoxSettings>()->bEnableVoiceOcclusion)
+	{
+		TickOcclusion(DeltaTime);
+	}
+}
+
+//Occlusion
+
+void UVivoxPositionalChannelObject::RegisterParticipantActor(const FString& AccountName, AActor* Actor)
+{
+	if (AccountName == "" || !IsValid(Actor))
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Cannot register occlusion actor , account name or actor is invalid"));
+		return;
+	}
+
+	FVivoxOcclusionEntry& Entry = OcclusionEntries.FindOrAdd(AccountName);
+	Entry.Actor = Actor;
+	OcclusionOrder.AddUnique(AccountName);
+}
+
+void UVivoxPositionalChannelObject::UnregisterParticipantActor(const FString& AccountName)
+{
+	FVivoxOcclusionEntry* Entry = OcclusionEntries.Find(AccountName);
+	if (Entry == nullptr)
+		return;
+
+	Entry->TargetOcclusion = 0.0f;
+	Entry->CurrentOcclusion = 0.0f;
+	ApplyOcclusionVolume(*Entry);
+	OcclusionEntries.Remove(AccountName);
+	OcclusionOrder.Remove(AccountName);
+}
+
+void UVivoxPositionalChannelObject::SetOcclusionListenerActor(AActor* Actor)
+{
+	OcclusionListenerActor = Actor;
+}
+
+float UVivoxPositionalChannelObject::GetParticipantOcclusion(const FString& AccountName) const
+{
+	const FVivoxOcclusionEntry* Entry = OcclusionEntries.Find(AccountName);
+	return Entry ? Entry->CurrentOcclusion : 0.0f;
+}
+
+void UVivoxPositionalChannelObject::TickOcclusion(float DeltaTime)
+{
+	UGameInstance* GameInstance = Cast<UGameInstance>(GetOuter());
+	UWorld* World = GameInstance ? GameInstance->GetWorld() : nullptr;
+	if (World == nullptr)
+		return;
+
+	CollectOcclusionResults(World);
+	StartOcclusionTraces(World);
+
+	const float SmoothingSpeed = GetDefault<UVivoxSettings>()->OcclusionSmoothingSpeed;
+	for (TPair<FString, FVivoxOcclusionEntry>& Pair : OcclusionEntries)
+	{
+		FVivoxOcclusionEntry& Entry = Pair.Value;
+		Entry.CurrentOcclusion = FMath::FInterpTo(Entry.CurrentOcclusion, Entry.TargetOcclusion, DeltaTime, SmoothingSpeed);
+		if (Entry.ParticipantId == "" && !ResolveParticipantId(Pair.Key, Entry))
+			continue;
+
+		ApplyOcclusionVolume(Entry);
+	}
+}
+
+void UVivoxPositionalChannelObject::CollectOcclusionResults(UWorld* World)
+{
+	for (TPair<FString, FVivoxOcclusionEntry>& Pair : OcclusionEntries)
+	{
+		FVivoxOcclusionEntry& Entry = Pair.Value;
+		if (!Entry.PendingTrace.IsValid())
+			continue;
+
+		FTraceDatum Result;
+		if (World->QueryTraceData(Entry.PendingTrace, Result))
+		{
+			//Test traces only report whether something blocked the line
+			Entry.TargetOcclusion = (Result.OutHits.Num() > 0 && Result.OutHits[0].bBlockingHit) ? 1.0f : 0.0f;
+			Entry.PendingTrace = FTraceHandle();
+		}
+		else if (!World->IsTraceHandleValid(Entry.PendingTrace, false))
+		{
+			//Result expired before it was read , trace again on the next turn
+			Entry.PendingTrace = FTraceHandle();
+		}
+	}
+}
+
+void UVivoxPositionalChannelObject::StartOcclusionTraces(UWorld* World)
+{
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	const FVector ListenerLocation = CachedPosition.GetValue();
+	const float MaxDistanceSquared = FMath::Square(static_cast<float>(Setting->AudibleDistance));
+
+	int32 TracesLeft = Setting->OcclusionTracesPerFrame;
+	for (int32 Visited = 0; Visited < OcclusionOrder.Num() && TracesLeft > 0; ++Visited)
+	{
+		NextOcclusionIndex = (NextOcclusionIndex + 1) % OcclusionOrder.Num();
+		FVivoxOcclusionEntry* Entry = OcclusionEntries.Find(OcclusionOrder[NextOcclusionIndex]);
+		if (Entry == nullptr || Entry->PendingTrace.IsValid())
+			continue;
+
+		AActor* Actor = Entry->Actor.Get();
+		if (Actor == nullptr)
+		{
+			Entry->TargetOcclusion = 0.0f;
+			continue;
+		}
+
+		//Out of hearing range the volume is zero anyway , no need to spend a trace
+		const FVector ActorLocation = Actor->GetActorLocation();
+		if (FVector::DistSquared(ListenerLocation, ActorLocation) > MaxDistanceSquared)
+			continue;
+
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(VivoxVoiceOcclusion), false);
+		Params.AddIgnoredActor(Actor);
+		if (AActor* Listener = OcclusionListenerActor.Get())
+		{
+			Params.AddIgnoredActor(Listener);
+		}
+		Entry->PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Test, ListenerLocation, ActorLocation, Setting->OcclusionTraceChannel, Params);
+		--TracesLeft;
+	}
+}
+
+void UVivoxPositionalChannelObject::ApplyOcclusionVolume(FVivoxOcclusionEntry& Entry)
+{
+	const int32 Adjustment = FMath::RoundToInt(Entry.CurrentOcclusion * GetDefault<UVivoxSettings>()->OccludedVolumeAdjustment);
+	if (Adjustment == Entry.AppliedVolumeAdjustment || ChannelSession == nullptr || Entry.ParticipantId == "")
+		return;
+
+	if (IParticipant* const* Participant = ChannelSession->Participants().Find(Entry.ParticipantId))
+	{
+		(*Participant)->SetLocalVolumeAdjustment(Adjustment);
+		Entry.AppliedVolumeAdjustment = Adjustment;
+	}
+	else
+	{
+		//Participant left , resolve again if it comes back
+		Entry.ParticipantId = "";
+		Entry.AppliedVolumeAdjustment = 0;
+	}
+}
+
+bool UVivoxPositionalChannelObject::ResolveParticipantId(const FString& AccountName, FVivoxOcclusionEntry& Entry) const
+{
+	for (const TPair<FString, FVivoxParticipantState>& Pair : GetParticipantMap())
+	{
+		if (Pair.Value.AccountName == AccountName)
+		{
+			Entry.ParticipantId = Pair.Key;
+			Entry.AppliedVolumeAdjustment = 0;
+			return true;
+		}
+	}
+	return false;
+}
+
+//Memory
+
+void UVivoxPositionalChannelObject::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T Size = OcclusionEntries.GetAllocatedSize() + OcclusionOrder.GetAllocatedSize();
+	for (const TPair<FString, FVivoxOcclusionEntry>& Pair : OcclusionEntries)
+	{
+		Size += Pair.Key.GetAllocatedSize() * 2 + Pair.Value.ParticipantId.GetAllocatedSize();
+	}
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Size);
+}
@@ -0,0 +1,258 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Replay/VivoxEventLog.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace VivoxEventLog
+{
+	static const uint32 Magic = 0x4C525856; // "VXRL"
+	static const uint32 Version = 1;
+	//Time delta and type , the smallest record an event can have
+	static const int64 MinEventBytes = sizeof(float) + sizeof(uint8);
+
+	//Writes a string the first time it is seen and its index afterwards
+	struct FStringTable
+	{
+		TMap<FString, int32>& Indices;
+		TArray<FString>& Strings;
+
+		void Serialize(FArchive& Ar, FString& Value)
+		{
+			if (Ar.IsSaving())
+			{
+				const int32* Found = Indices.Find(Value);
+				uint32 Index = Found ? *Found : Strings.Num();
+				Ar.SerializeIntPacked(Index);
+				if (Found == nullptr)
+				{
+					Indices.Add(Value, Strings.Add(Value));
+					Ar << Value;
+				}
+			}
+			else
+			{
+				uint32 Index = 0;
+				Ar.SerializeIntPacked(Index);
+				if (Index == static_cast<uint32>(Strings.Num()))
+				{
+					Ar << Value;
+					Strings.Add(Value);
+				}
+				else if (Strings.IsValidIndex(Index))
+				{
+					Value = Strings[Index];
+				}
+				else
+				{
+					Ar.SetError();
+				}
+			}
+		}
+	};
+
+	static void SerializeVector(FArchive& Ar, FVector& Vector)
+	{
+		//Float precision is plenty for positions and keeps records small
+		FVector3f Compact(Vector);
+		Ar << Compact;
+		Vector = FVector(Compact);
+	}
+
+	static void SerializeEvent(FArchive& Ar, FVivoxRecordedEvent& Event, FStringTable& Table)
+	{
+		uint8 Type = static_cast<uint8>(Event.Type);
+		Ar << Type;
+		Event.Type = static_cast<EVivoxRecordedEventType>(Type);
+
+		if (Event.IsChannelEvent())
+		{
+			uint8 ChannelType = static_cast<uint8>(Event.ChannelType);
+			Ar << ChannelType;
+			Event.ChannelType = static_cast<EVivoxChannelType>(ChannelType);
+			Table.Serialize(Ar, Event.ChannelSessionId);
+		}
+
+		switch (Event.Type)
+		{
+		case EVivoxRecordedEventType::LoginCompleted:
+		case EVivoxRecordedEventType::ConnectCompleted:
+		case EVivoxRecordedEventType::ApiJoinChannel:
+		case EVivoxRecordedEventType::ApiSetAudioConnected:
+		case EVivoxRecordedEventType::ChannelStateChanged:
+		case EVivoxRecordedEventType::AudioStateChanged:
+		case EVivoxRecordedEventType::TextStateChanged:
+			Ar << Event.Value;
+			break;
+		case EVivoxRecordedEventType::ParticipantAdded:
+		case EVivoxRecordedEventType::ParticipantUpdated:
+		case EVivoxRecordedEventType::ParticipantRemoved:
+		{
+			Table.Serialize(Ar, Event.Participant.ParticipantId);
+			Table.Serialize(Ar, Event.Participant.AccountName);
+			Table.Serialize(Ar, Event.Participant.DisplayName);
+			uint8 Flags = (Event.Participant.bIsSelf ? 1 : 0) | (Event.Participant.bInAudio ? 2 : 0) | (Event.Participant.bSpeechDetected ? 4 : 0);
+			Ar << Flags;
+			Event.Participant.bIsSelf = (Flags & 1) != 0;
+			Event.Participant.bInAudio = (Flags & 2) != 0;
+			Event.Participant.bSpeechDetected = (Flags & 4) != 0;
+			float Energy = static_cast<float>(Event.Participant.AudioEnergy);
+			Ar << Energy;
+			Event.Participant.AudioEnergy = Energy;
+			break;
+		}
+		case EVivoxRecordedEventType::TextMessageReceived:
+			Table.Serialize(Ar, Event.Name);
+			Ar << Event.Text;
+			break;
+		case EVivoxRecordedEventType::DeviceChanged:
+			Ar << Event.Value;
+			Table.Serialize(Ar, Event.Name);
+			break;
+		case EVivoxRecordedEventType::ApiLogin:
+			Table.Serialize(Ar, Event.Name);
+			break;
+		case EVivoxRecordedEventType::ApiUpdate3dPosition:
+			SerializeVector(Ar, Event.Position);
+			SerializeVector(Ar, Event.ForwardVector);
+			SerializeVector(Ar, Event.UpVector);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+bool FVivoxRecordedEvent::IsChannelEvent() const
+{
+	switch (Type)
+	{
+	case EVivoxRecordedEventType::LoginCompleted:
+	case EVivoxRecordedEventType::DeviceChanged:
+	case EVivoxRecordedEventType::ApiLogin:
+	case EVivoxRecordedEventType::ApiLogout:
+		return false;
+	default:
+		return true;
+	}
+}
+
+//Recorder
+
+FVivoxEventRecorder::FVivoxEventRecorder()
+{
+	StartTime = FPlatformTime::Seconds();
+	LastTime = 0.0;
+}
+
+void FVivoxEventRecorder::Record(FVivoxRecordedEvent& Event)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	Event.Time = FPlatformTime::Seconds() - StartTime;
+
+	FMemoryWriter Writer(Buffer, false, true);
+	float DeltaTime = static_cast<float>(Event.Time - LastTime);
+	Writer << DeltaTime;
+	VivoxEventLog::FStringTable Table{ StringIndices, Strings };
+	VivoxEventLog::SerializeEvent(Writer, Event, Table);
+
+	LastTime = Event.Time;
+	++NumEvents;
+}
+
+SIZE_T FVivoxEventRecorder::GetAllocatedSize() const
+{
+	SIZE_T Size = Buffer.GetAllocatedSize() + StringIndices.GetAllocatedSize() + Strings.GetAllocatedSize();
+	for (const FString& String : Strings)
+	{
+		//Every string is held twice , as table entry and as map key
+		Size += String.GetAllocatedSize() * 2;
+	}
+	return Size;
+}
+
+bool FVivoxEventRecorder::SaveToFile(const FString& FilePath) const
+{
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+	uint32 Magic = VivoxEventLog::Magic;
+	uint32 Version = VivoxEventLog::Version;
+	int32 Count = NumEvents;
+	Writer << Magic << Version << Count;
+	FileData.Append(Buffer);
+	return FFileHelper::SaveArrayToFile(FileData, *FilePath);
+}
+
+//Replayer
+
+bool FVivoxEventReplayer::LoadFromFile(const FString& FilePath)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	Events.Reset();
+	NextEvent = 0;
+	ElapsedTime = 0.0;
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+	{
+		UE_LOG(LogVivox, Error, TEXT("Cannot read vivox event log %s"), *FilePath);
+		return false;
+	}
+
+	FMemoryReader Reader(FileData);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 Count = 0;
+	Reader << Magic << Version << Count;
+	if (Magic != VivoxEventLog::Magic || Version != VivoxEventLog::Version || Count < 0)
+	{
+		UE_LOG(LogVivox, Error, TEXT("%s is not a vivox event log of version %u"), *FilePath, VivoxEventLog::Version);
+		return false;
+	}
+
+	TMap<FString, int32> StringIndices;
+	TArray<FString> Strings;
+	VivoxEventLog::FStringTable Table{ StringIndices, Strings };
+	double Time = 0.0;
+	//The header count is untrusted , a corrupted one must not reserve more events than the file can hold
+	Events.Reserve(static_cast<int32>(FMath::Min<int64>(Count, (FileData.Num() - Reader.Tell()) / VivoxEventLog::MinEventBytes)));
+	for (int32 Index = 0; Index < Count && !Reader.IsError(); ++Index)
+	{
+		float DeltaTime = 0.0f;
+		Reader << DeltaTime;
+		FVivoxRecordedEvent& Event = Events.AddDefaulted_GetRef();
+		VivoxEventLog::SerializeEvent(Reader, Event, Table);
+		Time += DeltaTime;
+		Event.Time = Time;
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogVivox, Error, TEXT("Vivox event log %s is corrupted"), *FilePath);
+		Events.Reset();
+		return false;
+	}
+	return true;
+}
+
+void FVivoxEventReplayer::Advance(float DeltaTime, float Speed, TFunctionRef<void(const FVivoxRecordedEvent&)> Dispatch)
+{
+	ElapsedTime = Speed > 0.0f ? ElapsedTime + DeltaTime * Speed : TNumericLimits<double>::Max();
+	while (NextEvent < Events.Num() && Events[NextEvent].Time <= ElapsedTime)
+	{
+		Dispatch(Events[NextEvent++]);
+	}
+}
+
+SIZE_T FVivoxEventReplayer::GetAllocatedSize() const
+{
+	SIZE_T Size = Events.GetAllocatedSize();
+	for (const FVivoxRecordedEvent& Event : Events)
+	{
+		Size += Event.ChannelSessionId.GetAllocatedSize() + Event.Name.GetAllocatedSize() + Event.Text.GetAllocatedSize();
+		Size += Event.Participant.ParticipantId.GetAllocatedSize() + Event.Participant.AccountName.GetAllocatedSize() + Event.Participant.DisplayName.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -3,4 +3,6 @@
 
 #include "Resource/VivoxResource.h"
 
-DEFINE_LOG_CATEGORY(LogVivox);
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogVivox);
+
+LLM_DEFINE_TAG(Vivox);
\ No newline at end of file
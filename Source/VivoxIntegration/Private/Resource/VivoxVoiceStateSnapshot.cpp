@@ -0,0 +1,109 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Resource/VivoxVoiceStateSnapshot.h"
+
+//FVivoxVoiceStateSnapshot
+
+const FVivoxChannelSnapshot* FVivoxVoiceStateSnapshot::FindChannel(FName ChannelSessionId) const
+{
+	return Channels.FindByPredicate([ChannelSessionId](const FVivoxChannelSnapshot& Channel)
+		{
+			return Channel.ChannelSessionId == ChannelSessionId;
+		});
+}
+
+bool FVivoxVoiceStateSnapshot::IsSpeaking(FName AccountName, float& AudioEnergy) const
+{
+	bool bSpeaking = false;
+	AudioEnergy = 0.0f;
+	for (const FVivoxParticipantSnapshot& Participant : Participants)
+	{
+		if (Participant.AccountName == AccountName)
+		{
+			bSpeaking |= Participant.bSpeechDetected;
+			AudioEnergy = FMath::Max(AudioEnergy, Participant.AudioEnergy);
+		}
+	}
+	return bSpeaking;
+}
+
+void FVivoxVoiceStateSnapshot::Reset()
+{
+	FrameNumber = 0;
+	Time = 0.0;
+	Channels.Reset();
+	Participants.Reset();
+}
+
+//FVivoxVoiceStateReadScope
+
+FVivoxVoiceStateReadScope::FVivoxVoiceStateReadScope(const FVivoxVoiceStateBuffer* InBuffer, int32 InSlot)
+	: Buffer(InBuffer)
+	, Snapshot(&InBuffer->Snapshots[InSlot])
+	, Slot(InSlot)
+{
+}
+
+FVivoxVoiceStateReadScope::FVivoxVoiceStateReadScope(FVivoxVoiceStateReadScope&& Other)
+	: Buffer(Other.Buffer)
+	, Snapshot(Other.Snapshot)
+	, Slot(Other.Slot)
+{
+	Other.Buffer = nullptr;
+	Other.Snapshot = nullptr;
+	Other.Slot = INDEX_NONE;
+}
+
+FVivoxVoiceStateReadScope::~FVivoxVoiceStateReadScope()
+{
+	if (Buffer != nullptr)
+	{
+		Buffer->Unpin(Slot);
+	}
+}
+
+//FVivoxVoiceStateBuffer
+
+FVivoxVoiceStateReadScope FVivoxVoiceStateBuffer::Read() const
+{
+	for (;;)
+	{
+		const int32 Slot = FrontSlot.load();
+		ReaderCounts[Slot].fetch_add(1);
+
+		//The slot can have become the back snapshot between the load and the pin , the writer may already be filling it
+		if (FrontSlot.load() == Slot)
+		{
+			return FVivoxVoiceStateReadScope(this, Slot);
+		}
+		ReaderCounts[Slot].fetch_sub(1);
+	}
+}
+
+void FVivoxVoiceStateBuffer::Unpin(int32 Slot) const
+{
+	ReaderCounts[Slot].fetch_sub(1);
+}
+
+bool FVivoxVoiceStateBuffer::TryPublish(TFunctionRef<void(FVivoxVoiceStateSnapshot&)> Fill)
+{
+	check(IsInGameThread());
+
+	//Sequentially consistent with the pin and check of Read , a reader pinning the back slot after this check sees it is not the front and retries
+	const int32 BackSlot = 1 - FrontSlot.load();
+	if (ReaderCounts[BackSlot].load() > 0)
+	{
+		++NumSkippedPublishes;
+		return false;
+	}
+
+	FVivoxVoiceStateSnapshot& Snapshot = Snapshots[BackSlot];
+	Snapshot.Reset();
+	Fill(Snapshot);
+	Snapshot.FrameNumber = GFrameCounter;
+	Snapshot.Time = FPlatformTime::Seconds();
+
+	FrontSlot.store(BackSlot);
+	return true;
+}
@@ -3,209 +3,2182 @@
 #include "Subsystem/VivoxSubSystem.h"
 #include "Library/VivoxHelperLibrary.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "VivoxSettings.h"
+#include "VivoxIntegration.h"
+#include "VivoxVoiceProfile.h"
+#include "Objects/VivoxPositionalChannelObject.h"
+#include "Objects/VivoxNonPositionalChannelObject.h"
+#include "Objects/VivoxEchoChannelObject.h"
+#include "Engine/GameInstance.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+
+bool UVivoxSubSystem::ShouldDisableVivox(const UGameInstance* GameInstance)
+{
+#if WITH_VIVOX_BACKEND
+	if (GameInstance && GameInstance->IsDedicatedServerInstance())
+		return true;
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("NoVivox")))
+		return true;
+
+	if (!FApp::CanEverRender() && GetDefault<UVivoxSettings>()->bDisableOnHeadlessClients)
+		return true;
+
+	return false;
+#else
+	return true;
+#endif
+}
+
+void UVivoxSubSystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	//Kept alive so GetSubsystem never returns null in shared gameplay code , the api checks the flag instead
+	bVivoxDisabled = ShouldDisableVivox(GetGameInstance());
+	if (bVivoxDisabled)
+	{
+		UE_LOG(LogVivox, Log, TEXT("Vivox is disabled in this game instance , voice chat calls are ignored"));
+	}
+}
+
+void UVivoxSubSystem::Deinitialize()
+{
+	DebugHud.Reset();
+	StopEventReplay();
+	//Gives the shared voice client back , other game instances keep using it
+	if (bVivoxClientInitialized)
+	{
+		UnInitializeVivox();
+	}
+	//A session still open when the game instance goes away gets its summary before the writer flushes
+	RecordSessionSummary();
+	StopMetrics();
+	Super::Deinitialize();
+}
 
 void UVivoxSubSystem::InitializeVivox()
 {
-	VivoxVoiceClient = &static_cast<FVivoxCoreModule*>(&FModuleManager::Get().LoadModuleChecked(TEXT("VivoxCore")))->VoiceClient();
+	if (bVivoxDisabled)
+		return;
+
+	LoadVivoxModule();
+	InitializeVivoxClient();
+}
+
+void UVivoxSubSystem::UnInitializeVivox()
+{
+	CancelVivoxBootstrap();
+	Logout();
+	RecordSessionSummary();
+	if (VivoxVoiceClient != nullptr)
+	{
+		VivoxVoiceClient->AudioInputDevices().EventEffectiveDeviceChanged.Remove(InputDeviceChangedHandle);
+		VivoxVoiceClient->AudioOutputDevices().EventEffectiveDeviceChanged.Remove(OutputDeviceChangedHandle);
+	}
+	if (bVivoxClientInitialized)
+	{
+		FVivoxIntegrationModule::Get().ReleaseVoiceClient();
+	}
+	VivoxVoiceClient = nullptr;
+	bVivoxClientInitialized = false;
+	StopMetrics();
+}
+
+void UVivoxSubSystem::LoadVivoxModule()
+{
+	LLM_SCOPE_BYTAG(Vivox);
+#if WITH_VIVOX_BACKEND
+	if (VivoxVoiceClient == nullptr)
+	{
+		VivoxVoiceClient = FVivoxIntegrationModule::Get().LoadVoiceClient();
+	}
+#else
+	UE_LOG(LogVivox, Warning, TEXT("Built without the vivox backend , voice chat is disabled"));
+#endif
+}
+
+void UVivoxSubSystem::InitializeVivoxClient()
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	if (VivoxVoiceClient != nullptr)
+	{
+		if (bVivoxClientInitialized)
+			return;
+
+		StartMetrics();
+		const double InitializeStartTime = FPlatformTime::Seconds();
+		//Only the first game instance pays for the sdk initialize , later ones share the client
+		const bool bInitializedClient = FVivoxIntegrationModule::Get().AcquireVoiceClient();
+		bVivoxClientInitialized = true;
+		const double InitializeSeconds = FPlatformTime::Seconds() - InitializeStartTime;
+		RecordMetric(TEXT("init"), [InitializeSeconds, bInitializedClient](FVivoxMetricsJsonWriter& Writer)
+			{
+				Writer.WriteValue(TEXT("seconds"), InitializeSeconds);
+				Writer.WriteValue(TEXT("shared"), !bInitializedClient);
+			});
+		InputDeviceChangedHandle = VivoxVoiceClient->AudioInputDevices().EventEffectiveDeviceChanged.AddUObject(this, &UVivoxSubSystem::OnEffectiveInputDeviceChanged);
+		OutputDeviceChangedHandle = VivoxVoiceClient->AudioOutputDevices().EventEffectiveDeviceChanged.AddUObject(this, &UVivoxSubSystem::OnEffectiveOutputDeviceChanged);
+		if (GetDefault<UVivoxSettings>()->bApplyVoiceProfileOnInitialize)
+		{
+			ApplyVoiceProfile();
+		}
+	}
+	else
+	{
+		UE_LOG(LogVivox, Error, TEXT("Failed to initialize vivox"));
+	}
+}
+
+bool UVivoxSubSystem::HasValidCredentials() const
+{
+	if (UsesExternalTokens())
+	{
+		return Credentials.Domain != "" && Credentials.Server != "" && Credentials.TokenIssuer != "" && ExternalLoginToken.Token != "";
+	}
+	return Credentials.Domain != "" && Credentials.Server != "" && Credentials.TokenIssuer != "" && Credentials.TokenKey != "";
+}
+
+//Server issued tokens
+
+bool UVivoxSubSystem::UsesExternalTokens()
+{
+	return GetDefault<UVivoxSettings>()->bUseServerIssuedTokens;
+}
+
+void UVivoxSubSystem::SetExternalTokens(const TArray<FVivoxIssuedToken>& Tokens)
+{
+	for (const FVivoxIssuedToken& Token : Tokens)
+	{
+		if (Token.Action == EVivoxTokenAction::Login)
+		{
+			ExternalLoginToken = Token;
+		}
+		else
+		{
+			ExternalJoinTokens.Add(MakeChannelKey(Token.ChannelType, Token.ChannelSessionId), Token);
+		}
+	}
+
+	//Desired channels waiting for their token can be joined now
+	bDesiredChannelsDirty = bDesiredChannelsActive;
+}
+
+const FVivoxIssuedToken* UVivoxSubSystem::FindExternalJoinToken(EVivoxChannelType ChannelType, const FString& ChannelSessionId) const
+{
+	const FVivoxIssuedToken* Token = ExternalJoinTokens.Find(MakeChannelKey(ChannelType, ChannelSessionId));
+	return (Token != nullptr && !Token->IsExpired()) ? Token : nullptr;
+}
+
+//Bootstrap
+
+void UVivoxSubSystem::BeginVivoxBootstrap(FString PlayerName, FOnVivoxBootstrapCompleted OnCompleted)
+{
+	if (bVivoxDisabled)
+	{
+		OnCompleted.ExecuteIfBound(false, FVivoxBootstrapTimings());
+		return;
+	}
+
+	if (BootstrapStage != EVivoxBootstrapStage::Idle)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Vivox bootstrap is already running"));
+		OnCompleted.ExecuteIfBound(false, FVivoxBootstrapTimings());
+		return;
+	}
+
+	if (PlayerName == "")
+	{
+		UE_LOG(LogVivox, Error, TEXT("Provided player name is empty cannot perform vivox action"));
+		OnCompleted.ExecuteIfBound(false, FVivoxBootstrapTimings());
+		return;
+	}
+
+	BootstrapPlayerName = PlayerName;
+	OnBootstrapCompleted = OnCompleted;
+	BootstrapTimings = FVivoxBootstrapTimings();
+	BootstrapStartTime = FPlatformTime::Seconds();
+	BootstrapStageStartTime = BootstrapStartTime;
+	BootstrapStage = EVivoxBootstrapStage::LoadingModule;
+}
+
+void UVivoxSubSystem::CancelVivoxBootstrap()
+{
+	if (BootstrapStage != EVivoxBootstrapStage::Idle)
+	{
+		UE_LOG(LogVivox, Log, TEXT("Vivox bootstrap cancelled"));
+		BootstrapStage = EVivoxBootstrapStage::Idle;
+		OnBootstrapCompleted.Unbind();
+	}
+}
+
+float UVivoxSubSystem::AdvanceBootstrapStage(EVivoxBootstrapStage NextStage)
+{
+	const double Now = FPlatformTime::Seconds();
+	const float StageSeconds = static_cast<float>(Now - BootstrapStageStartTime);
+	BootstrapStageStartTime = Now;
+	BootstrapStage = NextStage;
+	return StageSeconds;
+}
+
+void UVivoxSubSystem::TickBootstrap()
+{
+	//Module load and client initialize have to run on the game thread, they get a frame each so the loading screen keeps presenting
+	switch (BootstrapStage)
+	{
+	case EVivoxBootstrapStage::LoadingModule:
+		LoadVivoxModule();
+		BootstrapTimings.ModuleLoadSeconds = AdvanceBootstrapStage(EVivoxBootstrapStage::InitializingClient);
+		break;
+	case EVivoxBootstrapStage::InitializingClient:
+		InitializeVivoxClient();
+		if (!bVivoxClientInitialized)
+		{
+			FinishBootstrap(false);
+			return;
+		}
+		BootstrapTimings.ClientInitializeSeconds = AdvanceBootstrapStage(EVivoxBootstrapStage::WaitingForCredentials);
+		//Credentials fetched while the client initialized log in without waiting another frame
+		TryStartBootstrapLogin();
+		break;
+	case EVivoxBootstrapStage::WaitingForCredentials:
+		TryStartBootstrapLogin();
+		break;
+	case EVivoxBootstrapStage::LoggingIn:
+	case EVivoxBootstrapStage::JoiningChannels:
+	{
+		//A callback that never comes must not keep the bootstrap running forever
+		const float Timeout = GetDefault<UVivoxSettings>()->BootstrapStageTimeoutSeconds;
+		const float StageSeconds = static_cast<float>(FPlatformTime::Seconds() - BootstrapStageStartTime);
+		if (Timeout > 0.0f && StageSeconds > Timeout)
+		{
+			UE_LOG(LogVivox, Warning, TEXT("Vivox bootstrap timed out after %.1fs while %s"), StageSeconds, BootstrapStage == EVivoxBootstrapStage::LoggingIn ? TEXT("logging in") : TEXT("joining channels"));
+			(BootstrapStage == EVivoxBootstrapStage::LoggingIn ? BootstrapTimings.LoginSeconds : BootstrapTimings.ChannelJoinSeconds) = StageSeconds;
+			FinishBootstrap(false);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void UVivoxSubSystem::TryStartBootstrapLogin()
+{
+	if (!HasValidCredentials())
+		return;
+
+	BootstrapTimings.CredentialWaitSeconds = AdvanceBootstrapStage(EVivoxBootstrapStage::LoggingIn);
+	FOnVivoxLoggedIn OnLogin;
+	OnLogin.BindUFunction(this, GET_FUNCTION_NAME_CHECKED(UVivoxSubSystem, HandleBootstrapLoggedIn));
+	Login(BootstrapPlayerName, OnLogin);
+}
+
+void UVivoxSubSystem::HandleBootstrapLoggedIn(bool bLoginSuccessfull)
+{
+	if (BootstrapStage != EVivoxBootstrapStage::LoggingIn)
+		return;
+
+	BootstrapTimings.LoginSeconds = AdvanceBootstrapStage(EVivoxBootstrapStage::JoiningChannels);
+	if (!bLoginSuccessfull)
+	{
+		FinishBootstrap(false);
+		return;
+	}
+
+	//Entries without a channel id come from config , they fail the bootstrap instead of reaching the join checks
+	const TArray<FVivoxAutoJoinChannel>& AutoJoinChannels = GetDefault<UVivoxSettings>()->AutoJoinChannels;
+	BootstrapPendingJoins = 0;
+	BootstrapFailedJoins = 0;
+	for (const FVivoxAutoJoinChannel& AutoJoin : AutoJoinChannels)
+	{
+		if (AutoJoin.ChannelSessionId.IsEmpty())
+		{
+			UE_LOG(LogVivox, Error, TEXT("Vivox auto join channel has an empty ChannelSessionId , check AutoJoinChannels in vivox settings"));
+			++BootstrapFailedJoins;
+		}
+		else
+		{
+			++BootstrapPendingJoins;
+		}
+	}
+	if (BootstrapPendingJoins == 0)
+	{
+		BootstrapTimings.ChannelJoinSeconds = AdvanceBootstrapStage(EVivoxBootstrapStage::JoiningChannels);
+		FinishBootstrap(BootstrapFailedJoins == 0);
+		return;
+	}
+
+	//Joins are issued together, the SDK connects them in parallel
+	for (const FVivoxAutoJoinChannel& AutoJoin : AutoJoinChannels)
+	{
+		if (AutoJoin.ChannelSessionId.IsEmpty())
+			continue;
+
+		FOnVivoxChannelJoined OnJoined;
+		OnJoined.BindUFunction(this, GET_FUNCTION_NAME_CHECKED(UVivoxSubSystem, HandleBootstrapChannelJoined));
+		UVivoxChannelObject* ChannelObject = nullptr;
+		CreateAndJoinVoiceChannel(AutoJoin.ChannelSessionId, AutoJoin.ChannelType, OnJoined, ChannelObject, AutoJoin.bConnectAudio, AutoJoin.bTransmitAudio, AutoJoin.bConnectText);
+	}
+}
+
+void UVivoxSubSystem::HandleBootstrapChannelJoined(bool bJoinSuccessfull)
+{
+	if (BootstrapStage != EVivoxBootstrapStage::JoiningChannels)
+		return;
+
+	BootstrapFailedJoins += bJoinSuccessfull ? 0 : 1;
+	if (--BootstrapPendingJoins <= 0)
+	{
+		BootstrapTimings.ChannelJoinSeconds = AdvanceBootstrapStage(EVivoxBootstrapStage::JoiningChannels);
+		FinishBootstrap(BootstrapFailedJoins == 0);
+	}
+}
+
+void UVivoxSubSystem::FinishBootstrap(bool bSuccess)
+{
+	BootstrapTimings.TotalSeconds = static_cast<float>(FPlatformTime::Seconds() - BootstrapStartTime);
+	BootstrapStage = EVivoxBootstrapStage::Idle;
+	UE_LOG(LogVivox, Log, TEXT("Vivox bootstrap %s in %.3fs (module %.3fs , init %.3fs , credentials %.3fs , login %.3fs , join %.3fs)"),
+		bSuccess ? TEXT("succeeded") : TEXT("failed"), BootstrapTimings.TotalSeconds, BootstrapTimings.ModuleLoadSeconds, BootstrapTimings.ClientInitializeSeconds,
+		BootstrapTimings.CredentialWaitSeconds, BootstrapTimings.LoginSeconds, BootstrapTimings.ChannelJoinSeconds);
+
+	RecordMetric(TEXT("bootstrap"), [this, bSuccess](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("success"), bSuccess);
+			Writer.WriteValue(TEXT("module"), BootstrapTimings.ModuleLoadSeconds);
+			Writer.WriteValue(TEXT("init"), BootstrapTimings.ClientInitializeSeconds);
+			Writer.WriteValue(TEXT("credentials"), BootstrapTimings.CredentialWaitSeconds);
+			Writer.WriteValue(TEXT("login"), BootstrapTimings.LoginSeconds);
+			Writer.WriteValue(TEXT("join"), BootstrapTimings.ChannelJoinSeconds);
+			Writer.WriteValue(TEXT("total"), BootstrapTimings.TotalSeconds);
+		});
+
+	FOnVivoxBootstrapCompleted Completed = OnBootstrapCompleted;
+	OnBootstrapCompleted.Unbind();
+	Completed.ExecuteIfBound(bSuccess, BootstrapTimings);
+}
+
+//Tick
+
+void UVivoxSubSystem::Tick(float DeltaTime)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	if (BootstrapStage != EVivoxBootstrapStage::Idle)
+	{
+		TickBootstrap();
+	}
+
+	if (IsLogoutPending())
+	{
+		TickPendingLogout();
+	}
+
+	if (PendingLeaveOperations.Num() > 0)
+	{
+		PendingLeaveOperations.RemoveAll([](const TVivoxAsyncOperationRef<bool>& Operation)
+			{
+				return Operation->IsCompleted();
+			});
+	}
+
+	if (DeferredCompletions.Num() > 0)
+	{
+		//Moved out first so continuations can queue completions for the next frame
+		TArray<TPair<TVivoxAsyncOperationRef<bool>, bool>> Completions = MoveTemp(DeferredCompletions);
+		DeferredCompletions.Reset();
+		for (TPair<TVivoxAsyncOperationRef<bool>, bool>& Completion : Completions)
+		{
+			Completion.Key->Complete(Completion.Value);
+		}
+	}
+
+	ForEachChannel([DeltaTime](UVivoxChannelObject* ChannelObject)
+		{
+			ChannelObject->TickChannel(DeltaTime);
+		});
+
+	if (ShardedChannels.Num() > 0 && FPlatformTime::Seconds() >= NextShardCapacityCheckTime)
+	{
+		NextShardCapacityCheckTime = FPlatformTime::Seconds() + 1.0;
+		EnforceShardCapacity();
+	}
+
+	if (MetricsWriter.IsValid() && FPlatformTime::Seconds() >= NextMetricsSampleTime)
+	{
+		SampleChannelMetrics();
+	}
+
+	if (bSelfTestRunning)
+	{
+		//The channel is gone when it was left from outside (logout , budget eviction)
+		if (!SelfTestChannel.IsValid())
+		{
+			FinishVoiceSelfTest(false);
+		}
+		else if (SelfTestEndTime > 0.0 && FPlatformTime::Seconds() >= SelfTestEndTime)
+		{
+			FinishVoiceSelfTest(true);
+		}
+	}
+
+	if (IsValid(LoopbackSelfTestChannel))
+	{
+		LoopbackSelfTestChannel->TickChannel(DeltaTime);
+	}
+
+	for (const TPair<FString, UVivoxChannelObject*>& Pair : ReplayChannels)
+	{
+		if (IsValid(Pair.Value))
+		{
+			Pair.Value->TickChannel(DeltaTime);
+		}
+	}
+
+	if (EventReplayer.IsValid())
+	{
+		EventReplayer->Advance(DeltaTime, EventReplaySpeed, [this](const FVivoxRecordedEvent& Event)
+			{
+				DispatchReplayedEvent(Event);
+			});
+		if (EventReplayer.IsValid() && EventReplayer->IsFinished())
+		{
+			UE_LOG(LogVivox, Log, TEXT("Vivox event replay finished"));
+			EventReplayer.Reset();
+		}
+	}
+
+	if (bDesiredChannelsDirty)
+	{
+		bDesiredChannelsDirty = false;
+		ReconcileDesiredChannels();
+	}
+
+	if (bChannelBudgetDirty)
+	{
+		bChannelBudgetDirty = false;
+		EnforceChannelBudget();
+	}
+
+	if (GetDefault<UVivoxSettings>()->bPublishVoiceStateSnapshot)
+	{
+		PublishVoiceState();
+	}
+}
+
+ETickableTickType UVivoxSubSystem::GetTickableTickType() const
+{
+	//Conditional so a disabled subsystem does not tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UVivoxSubSystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVivoxSubSystem, STATGROUP_Tickables);
+}
+
+void UVivoxSubSystem::ForEachChannel(TFunctionRef<void(UVivoxChannelObject*)> Function) const
+{
+	for (const TMap<FString, UVivoxChannelObject*>* Registry : { &EchoChannels, &NonPostionalChannels, &PositionalChannels })
+	{
+		for (const TPair<FString, UVivoxChannelObject*>& Pair : *Registry)
+		{
+			if (IsValid(Pair.Value))
+			{
+				Function(Pair.Value);
+			}
+		}
+	}
+}
+
+TMap<FString, UVivoxChannelObject*>* UVivoxSubSystem::GetChannelRegistry(EVivoxChannelType ChannelType)
+{
+	switch (ChannelType)
+	{
+	case EVivoxChannelType::Positional:
+		return &PositionalChannels;
+	case EVivoxChannelType::NonPositional:
+		return &NonPostionalChannels;
+	case EVivoxChannelType::Echo:
+		return &EchoChannels;
+	default:
+		return nullptr;
+	}
+}
+
+TSubclassOf<UVivoxChannelObject> UVivoxSubSystem::GetChannelClass(EVivoxChannelType ChannelType)
+{
+	switch (ChannelType)
+	{
+	case EVivoxChannelType::Positional:
+		return UVivoxPositionalChannelObject::StaticClass();
+	case EVivoxChannelType::NonPositional:
+		return UVivoxNonPositionalChannelObject::StaticClass();
+	case EVivoxChannelType::Echo:
+		return UVivoxEchoChannelObject::StaticClass();
+	default:
+		return nullptr;
+	}
+}
+
+//Record and replay
+
+void UVivoxSubSystem::StartEventRecording()
+{
+	if (EventReplayer.IsValid())
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Cannot record vivox events while a replay is running"));
+		return;
+	}
+	EventRecorder = MakeUnique<FVivoxEventRecorder>();
+	UE_LOG(LogVivox, Log, TEXT("Vivox event recording started"));
+}
+
+bool UVivoxSubSystem::StopEventRecording(const FString& FilePath)
+{
+	if (!EventRecorder.IsValid())
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Vivox event recording is not running"));
+		return false;
+	}
+
+	const FString OutputPath = FilePath != "" ? FilePath : FPaths::ProjectSavedDir() / TEXT("Vivox") / FString::Printf(TEXT("Events_%s.vxrec"), *FDateTime::Now().ToString());
+	const bool bSaved = EventRecorder->SaveToFile(OutputPath);
+	UE_LOG(LogVivox, Log, TEXT("Vivox event recording of %d events %s %s"), EventRecorder->Num(), bSaved ? TEXT("written to") : TEXT("could not be written to"), *OutputPath);
+	EventRecorder.Reset();
+	return bSaved;
+}
+
+bool UVivoxSubSystem::StartEventReplay(const FString& FilePath, float Speed)
+{
+	if (EventRecorder.IsValid())
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Cannot replay vivox events while recording"));
+		return false;
+	}
+
+	TUniquePtr<FVivoxEventReplayer> Replayer = MakeUnique<FVivoxEventReplayer>();
+	if (!Replayer->LoadFromFile(FilePath))
+		return false;
+
+	UE_LOG(LogVivox, Log, TEXT("Replaying %d vivox events from %s at speed %.2f"), Replayer->Num(), *FilePath, Speed);
+	ReleaseReplayChannels();
+	bReplayLoggedIn = false;
+	ReplayLoginStartTime = 0.0;
+	ReplayDeviceFailovers = 0;
+	EventReplayer = MoveTemp(Replayer);
+	EventReplaySpeed = Speed;
+	return true;
+}
+
+void UVivoxSubSystem::StopEventReplay()
+{
+	EventReplayer.Reset();
+	ReleaseReplayChannels();
+}
+
+void UVivoxSubSystem::ReleaseReplayChannels()
+{
+	for (const TPair<FString, UVivoxChannelObject*>& Pair : ReplayChannels)
+	{
+		if (IsValid(Pair.Value))
+		{
+			Pair.Value->ShutdownChannel();
+		}
+	}
+	ReplayChannels.Empty();
+}
+
+void UVivoxSubSystem::DispatchReplayedEvent(const FVivoxRecordedEvent& Event)
+{
+	const FString Key = Event.IsChannelEvent() ? MakeChannelKey(Event.ChannelType, Event.ChannelSessionId) : FString();
+	UVivoxChannelObject* ChannelObject = Event.IsChannelEvent() ? ReplayChannels.FindRef(Key) : nullptr;
+
+	switch (Event.Type)
+	{
+	case EVivoxRecordedEventType::ApiJoinChannel:
+		//The replay stands in for the backend , channels get no channel session and only receive the recorded events
+		if (ChannelObject == nullptr && GetChannelClass(Event.ChannelType) != nullptr)
+		{
+			//Outered to the subsystem instead of the game instance , the channel then finds no subsystem to report to
+			ChannelObject = NewObject<UVivoxChannelObject>(this, GetChannelClass(Event.ChannelType));
+			ReplayChannels.Add(Key, ChannelObject);
+		}
+		if (ChannelObject)
+		{
+			ChannelObject->InitializeForReplay(Event.ChannelSessionId, (Event.Value & VivoxRecordedAudio_Listen) != 0, (Event.Value & VivoxRecordedAudio_Transmit) != 0, (Event.Value & VivoxRecordedAudio_Text) != 0);
+		}
+		break;
+	case EVivoxRecordedEventType::ApiSetAudioConnected:
+		if (ChannelObject)
+		{
+			ChannelObject->SetAudioConnected((Event.Value & VivoxRecordedAudio_Listen) != 0, (Event.Value & VivoxRecordedAudio_Transmit) != 0);
+		}
+		break;
+	case EVivoxRecordedEventType::ApiUpdate3dPosition:
+		if (ChannelObject)
+		{
+			ChannelObject->UpdateVivox3dPosition(Event.Position, Event.ForwardVector, Event.UpVector);
+		}
+		break;
+	case EVivoxRecordedEventType::ConnectCompleted:
+		if (ChannelObject)
+		{
+			ChannelObject->HandleConnectCompleted(Event.Value == 0);
+		}
+		break;
+	case EVivoxRecordedEventType::ChannelStateChanged:
+		if (ChannelObject)
+		{
+			ChannelObject->HandleChannelStateChanged(static_cast<ConnectionState>(Event.Value));
+		}
+		break;
+	case EVivoxRecordedEventType::AudioStateChanged:
+		if (ChannelObject)
+		{
+			ChannelObject->HandleAudioStateChanged(static_cast<ConnectionState>(Event.Value));
+		}
+		break;
+	case EVivoxRecordedEventType::TextStateChanged:
+		if (ChannelObject)
+		{
+			ChannelObject->HandleTextStateChanged(static_cast<ConnectionState>(Event.Value));
+		}
+		break;
+	case EVivoxRecordedEventType::ApiLeaveChannel:
+		if (ChannelObject)
+		{
+			ReplayChannels.Remove(Key);
+			ChannelObject->ShutdownChannel();
+		}
+		break;
+	case EVivoxRecordedEventType::ParticipantAdded:
+		if (ChannelObject)
+		{
+			ChannelObject->HandleParticipantAdded(Event.Participant);
+		}
+		break;
+	case EVivoxRecordedEventType::ParticipantUpdated:
+		if (ChannelObject)
+		{
+			ChannelObject->HandleParticipantUpdated(Event.Participant);
+		}
+		break;
+	case EVivoxRecordedEventType::ParticipantRemoved:
+		if (ChannelObject)
+		{
+			ChannelObject->HandleParticipantRemoved(Event.Participant);
+		}
+		break;
+	case EVivoxRecordedEventType::TextMessageReceived:
+		if (ChannelObject)
+		{
+			FVivoxTextMessage Message;
+			Message.SenderAccountName = Event.Name;
+			Message.Message = Event.Text;
+			Message.ReceivedTime = FDateTime::UtcNow();
+			ChannelObject->HandleTextMessageReceived(Message);
+		}
+		break;
+	case EVivoxRecordedEventType::ApiLogout:
+		//Only the replayed session logs out , live channels are never touched
+		ReleaseReplayChannels();
+		bReplayLoggedIn = false;
+		break;
+	case EVivoxRecordedEventType::ApiLogin:
+		//Login time is measured on the recorded timeline so the replay speed does not skew it
+		bReplayLoggedIn = false;
+		ReplayLoginStartTime = Event.Time;
+		ReplayDeviceFailovers = 0;
+		break;
+	case EVivoxRecordedEventType::LoginCompleted:
+		HandleLoginCompleted(static_cast<VivoxCoreError>(Event.Value), Event.Time - ReplayLoginStartTime, true);
+		break;
+	case EVivoxRecordedEventType::DeviceChanged:
+		HandleEffectiveDeviceChanged(Event.Value != 0, Event.Name, true);
+		break;
+	default:
+		break;
+	}
+}
+
+void UVivoxSubSystem::OnEffectiveInputDeviceChanged(const IAudioDevice& Device)
+{
+	HandleEffectiveDeviceChanged(false, Device.Name(), false);
+}
+
+void UVivoxSubSystem::OnEffectiveOutputDeviceChanged(const IAudioDevice& Device)
+{
+	HandleEffectiveDeviceChanged(true, Device.Name(), false);
+}
+
+void UVivoxSubSystem::HandleEffectiveDeviceChanged(bool bOutput, const FString& DeviceName, bool bReplayed)
+{
+	if (!bReplayed)
+	{
+		FVivoxRecordedEvent Event;
+		Event.Type = EVivoxRecordedEventType::DeviceChanged;
+		Event.Value = bOutput ? 1 : 0;
+		Event.Name = DeviceName;
+		RecordEvent(Event);
+	}
+	RecordDeviceFailover(bOutput ? TEXT("output") : TEXT("input"), DeviceName, bReplayed);
+}
+
+void UVivoxSubSystem::HandleLoginCompleted(VivoxCoreError Error, double LoginSeconds, bool bReplayed)
+{
+	if (bReplayed)
+	{
+		bReplayLoggedIn = (Error == 0);
+		UE_LOG(LogVivox, Log, TEXT("Replayed vivox login completed in %.3fs with error %d"), LoginSeconds, static_cast<int32>(Error));
+		return;
+	}
+
+	FVivoxRecordedEvent LoginCompletedEvent;
+	LoginCompletedEvent.Type = EVivoxRecordedEventType::LoginCompleted;
+	LoginCompletedEvent.Value = Error;
+	RecordEvent(LoginCompletedEvent);
+
+	bIsLoggedIn = (Error == 0) ? true : false;
+	RecordMetric(TEXT("login"), [LoginSeconds, Error](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("seconds"), LoginSeconds);
+			Writer.WriteValue(TEXT("success"), Error == 0);
+			Writer.WriteValue(TEXT("error"), static_cast<int32>(Error));
+		});
+}
+
+static UVivoxSubSystem* GetVivoxSubSystemForWorld(UWorld* World)
+{
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UVivoxSubSystem>() : nullptr;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs VivoxRecordCommand(
+	TEXT("Vivox.Record"),
+	TEXT("Vivox.Record start | stop [FilePath] , records vivox callbacks and api calls into a binary event log"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubSystemForWorld(World))
+			{
+				if (Args.Num() > 0 && Args[0] == TEXT("stop"))
+				{
+					VivoxSubsystem->StopEventRecording(Args.Num() > 1 ? Args[1] : FString());
+				}
+				else
+				{
+					VivoxSubsystem->StartEventRecording();
+				}
+			}
+		}));
+
+static FAutoConsoleCommandWithWorldAndArgs VivoxReplayCommand(
+	TEXT("Vivox.Replay"),
+	TEXT("Vivox.Replay FilePath [Speed] | stop , replays a vivox event log into offline channels , speed 0 replays it in one frame"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubSystemForWorld(World))
+			{
+				if (Args.Num() == 0 || Args[0] == TEXT("stop"))
+				{
+					VivoxSubsystem->StopEventReplay();
+				}
+				else
+				{
+					VivoxSubsystem->StartEventReplay(Args[0], Args.Num() > 1 ? FCString::Atof(*Args[1]) : 1.0f);
+				}
+			}
+		}));
+
+static FAutoConsoleCommandWithWorldAndArgs VivoxDumpMemoryCommand(
+	TEXT("Vivox.DumpMemory"),
+	TEXT("Vivox.DumpMemory , logs the memory used by the vivox subsystem and every voice channel"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubSystemForWorld(World))
+			{
+				VivoxSubsystem->DumpMemoryUsage();
+			}
+		}));
+
+static FAutoConsoleCommandWithWorldAndArgs VivoxDebugHudCommand(
+	TEXT("Vivox.DebugHud"),
+	TEXT("Vivox.DebugHud [0|1] , toggles the on screen voice debug overlay"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubSystemForWorld(World))
+			{
+				VivoxSubsystem->SetDebugHudEnabled(Args.Num() > 0 ? FCString::Atoi(*Args[0]) != 0 : !VivoxSubsystem->IsDebugHudEnabled());
+			}
+		}));
+
+static FAutoConsoleCommandWithWorldAndArgs VivoxSelfTestCommand(
+	TEXT("Vivox.SelfTest"),
+	TEXT("Vivox.SelfTest [Seconds] [loopback] , runs the echo channel voice self test and logs latency percentiles , input level and clipping"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UVivoxSubSystem* VivoxSubsystem = GetVivoxSubSystemForWorld(World))
+			{
+				const float DurationSeconds = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 10.0f;
+				const bool bUseLoopback = Args.Num() > 1 && Args[1].Equals(TEXT("loopback"), ESearchCase::IgnoreCase);
+				VivoxSubsystem->StartVoiceSelfTest(DurationSeconds, bUseLoopback, FOnVivoxSelfTestCompleted());
+			}
+		}));
+
+//Voice self test
+
+bool UVivoxSubSystem::StartVoiceSelfTest(float DurationSeconds, bool bUseLoopback, FOnVivoxSelfTestCompleted OnCompleted)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	if (bVivoxDisabled)
+		return false;
+
+	if (bSelfTestRunning)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("A vivox self test is already running"));
+		return false;
+	}
+
+	//Without a client there is nothing to echo through , the loopback stands in
+	const bool bLoopback = bUseLoopback || VivoxVoiceClient == nullptr;
+	if (!bLoopback && !bIsLoggedIn)
+	{
+		UE_LOG(LogVivox, Error, TEXT("Cannot start vivox self test, because not logged in to vivox try login first"));
+		return false;
+	}
+
+	//The server only issues tokens for assigned channels , a private echo channel needs the local TokenKey
+	if (!bLoopback && UsesExternalTokens())
+	{
+		UE_LOG(LogVivox, Error, TEXT("Cannot start vivox self test with server issued tokens , use the loopback"));
+		return false;
+	}
+
+	const FString ChannelSessionId = FString::Printf(TEXT("selftest_%s"), *FGuid::NewGuid().ToString(EGuidFormats::Digits));
+	SelfTestDuration = FMath::Max(DurationSeconds, 1.0f);
+	SelfTestEndTime = 0.0;
+	OnSelfTestCompleted = OnCompleted;
+	bSelfTestRunning = true;
+
+	if (bLoopback)
+	{
+		//Same path the replay uses , a channel object without a channel session that the budget , metrics , snapshot and hud never see
+		UVivoxEchoChannelObject* EchoChannel = NewObject<UVivoxEchoChannelObject>(this);
+		EchoChannel->InitializeForReplay(ChannelSessionId, true, true, false);
+		LoopbackSelfTestChannel = EchoChannel;
+		SelfTestChannel = EchoChannel;
+		EchoChannel->StartProbe(true);
+		SelfTestEndTime = FPlatformTime::Seconds() + SelfTestDuration;
+	}
+	else
+	{
+		//Joining with transmission switches it to the echo channel
+		if (LoginSession != nullptr)
+		{
+			bSelfTestTransmissionSaved = true;
+			SelfTestSavedTransmissionMode = LoginSession->GetTransmissionMode();
+			const TArray<ChannelId> TransmittingChannels = LoginSession->GetTransmittingChannels();
+			SelfTestSavedTransmissionChannel = TransmittingChannels.Num() > 0 ? TransmittingChannels[0] : ChannelId();
+		}
+
+		FOnVivoxChannelJoined OnJoined;
+		OnJoined.BindUFunction(this, GET_FUNCTION_NAME_CHECKED(UVivoxSubSystem, HandleSelfTestChannelJoined));
+		UVivoxChannelObject* ChannelObject = nullptr;
+		CreateAndJoinVoiceChannel(ChannelSessionId, EVivoxChannelType::Echo, OnJoined, ChannelObject, true, true, false);
+		SelfTestChannel = Cast<UVivoxEchoChannelObject>(ChannelObject);
+		if (!SelfTestChannel.IsValid())
+		{
+			FinishVoiceSelfTest(false);
+			return false;
+		}
+	}
+
+	UE_LOG(LogVivox, Log, TEXT("Started %s vivox self test for %.1f seconds"), bLoopback ? TEXT("loopback") : TEXT("echo channel"), SelfTestDuration);
+	return true;
+}
+
+void UVivoxSubSystem::HandleSelfTestChannelJoined(bool bJoinSuccessfull)
+{
+	UVivoxEchoChannelObject* EchoChannel = SelfTestChannel.Get();
+	if (!bSelfTestRunning || EchoChannel == nullptr)
+		return;
+
+	if (!bJoinSuccessfull)
+	{
+		FinishVoiceSelfTest(false);
+		return;
+	}
+
+	EchoChannel->StartProbe(false);
+	SelfTestEndTime = FPlatformTime::Seconds() + SelfTestDuration;
+}
+
+void UVivoxSubSystem::StopVoiceSelfTest()
+{
+	if (bSelfTestRunning)
+	{
+		FinishVoiceSelfTest(SelfTestChannel.IsValid() && SelfTestChannel->IsProbing());
+	}
+}
+
+FVivoxSelfTestResult UVivoxSubSystem::GetVoiceSelfTestProgress() const
+{
+	return SelfTestChannel.IsValid() ? SelfTestChannel->GetProbeResult() : FVivoxSelfTestResult();
+}
+
+void UVivoxSubSystem::FinishVoiceSelfTest(bool bSuccess)
+{
+	FVivoxSelfTestResult Result;
+	if (UVivoxEchoChannelObject* EchoChannel = SelfTestChannel.Get())
+	{
+		Result = EchoChannel->GetProbeResult();
+		EchoChannel->StopProbe();
+		if (EchoChannel == LoopbackSelfTestChannel)
+		{
+			//Nothing to leave , the offline channel is only torn down
+			EchoChannel->ShutdownChannel();
+		}
+		else
+		{
+			EchoChannel->LeaveChannel();
+		}
+	}
+	LoopbackSelfTestChannel = nullptr;
+	if (bSelfTestTransmissionSaved)
+	{
+		bSelfTestTransmissionSaved = false;
+		if (LoginSession != nullptr)
+		{
+			LoginSession->SetTransmissionMode(SelfTestSavedTransmissionMode, SelfTestSavedTransmissionChannel);
+		}
+	}
+	SelfTestChannel.Reset();
+	SelfTestEndTime = 0.0;
+	bSelfTestRunning = false;
+
+	UE_LOG(LogVivox, Log, TEXT("Vivox self test %s%s: %d round trips (%d missed) , latency min %.0f p50 %.0f p90 %.0f p99 %.0f max %.0f ms , input level avg %.2f peak %.2f , clipped %.1f%%"),
+		bSuccess ? TEXT("finished") : TEXT("failed"), Result.bLoopback ? TEXT(" (loopback)") : TEXT(""),
+		Result.RoundTrips, Result.MissedRoundTrips, Result.LatencyMinMs, Result.LatencyP50Ms, Result.LatencyP90Ms, Result.LatencyP99Ms, Result.LatencyMaxMs,
+		Result.InputLevelAverage, Result.InputLevelPeak, Result.ClippedRatio * 100.0f);
+	if (bSuccess && Result.RoundTrips == 0)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Vivox self test measured no round trips , check the input device and speak during the test"));
+	}
+
+	RecordMetric(TEXT("self_test"), [&Result, bSuccess](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("success"), bSuccess);
+			Writer.WriteValue(TEXT("loopback"), Result.bLoopback);
+			Writer.WriteValue(TEXT("round_trips"), Result.RoundTrips);
+			Writer.WriteValue(TEXT("missed"), Result.MissedRoundTrips);
+			Writer.WriteValue(TEXT("p50_ms"), Result.LatencyP50Ms);
+			Writer.WriteValue(TEXT("p90_ms"), Result.LatencyP90Ms);
+			Writer.WriteValue(TEXT("p99_ms"), Result.LatencyP99Ms);
+			Writer.WriteValue(TEXT("input_level"), Result.InputLevelAverage);
+			Writer.WriteValue(TEXT("clipped"), Result.ClippedRatio);
+		});
+
+	//Copied out first so the callback can start another test
+	FOnVivoxSelfTestCompleted Completed = OnSelfTestCompleted;
+	OnSelfTestCompleted.Unbind();
+	Completed.ExecuteIfBound(bSuccess, Result);
+}
+
+//Metrics
+
+FString UVivoxSubSystem::GetMetricsFileName() const
+{
+	FString FileName = FString::Printf(TEXT("VivoxMetrics_%u"), FPlatformProcess::GetCurrentProcessId());
+	const FWorldContext* WorldContext = GetGameInstance() ? GetGameInstance()->GetWorldContext() : nullptr;
+	if (WorldContext && WorldContext->PIEInstance != INDEX_NONE)
+	{
+		FileName += FString::Printf(TEXT("_PIE%d"), WorldContext->PIEInstance);
+	}
+	return FileName;
+}
+
+void UVivoxSubSystem::StartMetrics()
+{
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	if (!Setting->bEnableMetricsLog || MetricsWriter.IsValid())
+		return;
+
+	MetricsWriter = MakeUnique<FVivoxMetricsWriter>(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Vivox"), TEXT("Metrics")), GetMetricsFileName(),
+		Setting->MetricsMaxQueuedRecords, static_cast<int64>(Setting->MetricsMaxFileSizeKB) * 1024, Setting->MetricsMaxFiles);
+	NextMetricsSampleTime = FPlatformTime::Seconds() + Setting->MetricsSampleSeconds;
+	RecordMetric(TEXT("start"), [](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("platform"), FString(FPlatformProperties::IniPlatformName()));
+			Writer.WriteValue(TEXT("build"), FString(FApp::GetBuildVersion()));
+		});
+}
+
+void UVivoxSubSystem::StopMetrics()
+{
+	//The writer thread flushes what is queued before it exits
+	MetricsWriter.Reset();
+}
+
+void UVivoxSubSystem::SampleChannelMetrics()
+{
+	NextMetricsSampleTime = FPlatformTime::Seconds() + GetDefault<UVivoxSettings>()->MetricsSampleSeconds;
+	ForEachChannel([this](UVivoxChannelObject* ChannelObject)
+		{
+			const int32 NumParticipants = ChannelObject->GetNumParticipants();
+			const float PositionRate = ChannelObject->GetPositionUpdateRate();
+			SessionPeakParticipants = FMath::Max(SessionPeakParticipants, NumParticipants);
+			SessionPeakPositionRate = FMath::Max(SessionPeakPositionRate, PositionRate);
+			RecordMetric(TEXT("channel_sample"), [ChannelObject, NumParticipants, PositionRate](FVivoxMetricsJsonWriter& Writer)
+				{
+					Writer.WriteValue(TEXT("channel"), ChannelObject->GetChannelSessionId());
+					Writer.WriteValue(TEXT("type"), static_cast<int32>(ChannelObject->GetChannelType()));
+					Writer.WriteValue(TEXT("participants"), NumParticipants);
+					Writer.WriteValue(TEXT("position_rate"), PositionRate);
+					Writer.WriteValue(TEXT("idle_suspended"), ChannelObject->IsAudioIdleSuspended());
+				});
+		});
+}
+
+void UVivoxSubSystem::RecordSessionSummary()
+{
+	if (!bSessionSummaryPending)
+		return;
+
+	bSessionSummaryPending = false;
+	RecordMetric(TEXT("session"), [this](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("seconds"), FPlatformTime::Seconds() - LoginStartTime);
+			Writer.WriteValue(TEXT("reconnects"), SessionReconnects);
+			Writer.WriteValue(TEXT("device_failovers"), SessionDeviceFailovers);
+			Writer.WriteValue(TEXT("peak_participants"), SessionPeakParticipants);
+			Writer.WriteValue(TEXT("peak_position_rate"), SessionPeakPositionRate);
+		});
+}
+
+void UVivoxSubSystem::RecordDeviceFailover(const TCHAR* Direction, const FString& DeviceName, bool bReplayed)
+{
+	UE_LOG(LogVivox, Log, TEXT("Effective vivox %s device changed to %s%s"), Direction, *DeviceName, bReplayed ? TEXT(" (replayed)") : TEXT(""));
+	if (bReplayed)
+	{
+		++ReplayDeviceFailovers;
+		return;
+	}
+
+	++SessionDeviceFailovers;
+	RecordMetric(TEXT("device_failover"), [Direction, &DeviceName](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("direction"), FString(Direction));
+			Writer.WriteValue(TEXT("device"), DeviceName);
+		});
+}
+
+void UVivoxSubSystem::ReportChannelJoined(const UVivoxChannelObject* ChannelObject, bool bSuccess, float Seconds)
+{
+	//A channel joined next to speaker shards takes transmission mode all away
+	if (bSuccess && bShardTransmissionActive)
+	{
+		RefreshShardTransmission();
+	}
+
+	RecordMetric(TEXT("join"), [ChannelObject, bSuccess, Seconds](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("channel"), ChannelObject->GetChannelSessionId());
+			Writer.WriteValue(TEXT("type"), static_cast<int32>(ChannelObject->GetChannelType()));
+			Writer.WriteValue(TEXT("seconds"), Seconds);
+			Writer.WriteValue(TEXT("success"), bSuccess);
+		});
+}
+
+void UVivoxSubSystem::ReportChannelLeft(const UVivoxChannelObject* ChannelObject, double ConnectedSeconds, int32 PeakParticipants)
+{
+	SessionPeakParticipants = FMath::Max(SessionPeakParticipants, PeakParticipants);
+	RecordMetric(TEXT("leave"), [ChannelObject, ConnectedSeconds, PeakParticipants](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("channel"), ChannelObject->GetChannelSessionId());
+			Writer.WriteValue(TEXT("type"), static_cast<int32>(ChannelObject->GetChannelType()));
+			Writer.WriteValue(TEXT("connected_seconds"), ConnectedSeconds);
+			Writer.WriteValue(TEXT("peak_participants"), PeakParticipants);
+		});
+}
+
+void UVivoxSubSystem::ReportChannelReconnecting(const UVivoxChannelObject* ChannelObject)
+{
+	++SessionReconnects;
+	RecordMetric(TEXT("reconnect"), [ChannelObject](FVivoxMetricsJsonWriter& Writer)
+		{
+			Writer.WriteValue(TEXT("channel"), ChannelObject->GetChannelSessionId());
+		});
+}
+
+//Debug hud
+
+void UVivoxSubSystem::SetDebugHudEnabled(bool bEnabled)
+{
+	if (bEnabled && !DebugHud.IsValid())
+	{
+		DebugHud = MakeUnique<FVivoxDebugHud>(this);
+	}
+	else if (!bEnabled)
+	{
+		DebugHud.Reset();
+	}
+}
+
+//Memory
+
+void UVivoxSubSystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T Size = 0;
+	for (const TMap<FString, UVivoxChannelObject*>* Registry : { &EchoChannels, &NonPostionalChannels, &PositionalChannels })
+	{
+		Size += Registry->GetAllocatedSize();
+		for (const TPair<FString, UVivoxChannelObject*>& Pair : *Registry)
+		{
+			Size += Pair.Key.GetAllocatedSize();
+		}
+	}
+
+	Size += DesiredChannels.GetAllocatedSize();
+	for (const TPair<FString, FVivoxDesiredChannel>& Pair : DesiredChannels)
+	{
+		Size += Pair.Key.GetAllocatedSize() + Pair.Value.ChannelSessionId.GetAllocatedSize();
+	}
+	Size += BudgetEvictedChannels.GetAllocatedSize();
+	for (const FString& Key : BudgetEvictedChannels)
+	{
+		Size += Key.GetAllocatedSize();
+	}
+	Size += DesiredChannelBackoff.GetAllocatedSize();
+	for (const TPair<FString, FVivoxRejoinBackoff>& Pair : DesiredChannelBackoff)
+	{
+		Size += Pair.Key.GetAllocatedSize();
+	}
+
+	Size += ShardedChannels.GetAllocatedSize() + ShardSessionIds.GetAllocatedSize();
+	for (const TPair<FString, FVivoxShardedChannel>& Pair : ShardedChannels)
+	{
+		Size += Pair.Key.GetAllocatedSize() + Pair.Value.JoinedShards.GetAllocatedSize();
+	}
+	for (const FString& ShardId : ShardSessionIds)
+	{
+		Size += ShardId.GetAllocatedSize();
+	}
+
+	Size += DeferredCompletions.GetAllocatedSize();
+	Size += PendingLogoutChannels.GetAllocatedSize() + PendingLogoutOperations.GetAllocatedSize() + PendingLeaveOperations.GetAllocatedSize();
+	Size += ExternalJoinTokens.GetAllocatedSize();
+	Size += sizeof(FVivoxVoiceStateBuffer) + VoiceStateBuffer->GetAllocatedSize();
+	if (EventRecorder.IsValid())
+	{
+		Size += sizeof(FVivoxEventRecorder) + EventRecorder->GetAllocatedSize();
+	}
+	if (EventReplayer.IsValid())
+	{
+		Size += sizeof(FVivoxEventReplayer) + EventReplayer->GetAllocatedSize();
+	}
+	Size += ReplayChannels.GetAllocatedSize();
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Size);
+
+	//Channel objects are separate UObjects and report themselves in exclusive mode
+	if (CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal)
+	{
+		ForEachChannel([&CumulativeResourceSize](UVivoxChannelObject* ChannelObject)
+			{
+				ChannelObject->GetResourceSizeEx(CumulativeResourceSize);
+			});
+		if (IsValid(LoopbackSelfTestChannel))
+		{
+			LoopbackSelfTestChannel->GetResourceSizeEx(CumulativeResourceSize);
+		}
+	}
+}
+
+//Voice state snapshot
+
+void UVivoxSubSystem::PublishVoiceState()
+{
+	//Only cached channel state is read , the snapshot never touches the sdk objects
+	VoiceStateBuffer->TryPublish([this](FVivoxVoiceStateSnapshot& Snapshot)
+		{
+			ForEachChannel([&Snapshot](UVivoxChannelObject* ChannelObject)
+				{
+					FVivoxChannelSnapshot& Channel = Snapshot.Channels.AddDefaulted_GetRef();
+					Channel.ChannelSessionId = ChannelObject->GetChannelSessionName();
+					Channel.ChannelType = ChannelObject->GetChannelType();
+					Channel.ChannelState = ChannelObject->GetChannelConnectionState();
+					Channel.AudioState = ChannelObject->GetAudioConnectionState();
+					Channel.TextState = ChannelObject->GetTextConnectionState();
+					Channel.bAudioIdleSuspended = ChannelObject->IsAudioIdleSuspended();
+					Channel.bBudgetDemoted = ChannelObject->IsBudgetDemoted();
+					Channel.FirstParticipant = Snapshot.Participants.Num();
+
+					for (const TPair<FString, FVivoxParticipantState>& Pair : ChannelObject->GetParticipantMap())
+					{
+						const FVivoxParticipantState& State = Pair.Value;
+						FVivoxParticipantSnapshot& Participant = Snapshot.Participants.AddDefaulted_GetRef();
+						//Names are built when the participant is added , never per frame
+						Participant.ParticipantId = State.SnapshotParticipantId;
+						Participant.AccountName = State.SnapshotAccountName;
+						Participant.bIsSelf = State.bIsSelf;
+						Participant.bInAudio = State.bInAudio;
+						Participant.bSpeechDetected = State.bSpeechDetected;
+						Participant.AudioEnergy = static_cast<float>(State.AudioEnergy);
+					}
+					Channel.NumParticipants = Snapshot.Participants.Num() - Channel.FirstParticipant;
+				});
+		});
+}
+
+void UVivoxSubSystem::DumpMemoryUsage()
+{
+	const SIZE_T SubsystemBytes = GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	SIZE_T ChannelBytes = 0;
+	int32 NumChannels = 0;
+
+	UE_LOG(LogVivox, Display, TEXT("Vivox memory usage:"));
+	ForEachChannel([&ChannelBytes, &NumChannels](UVivoxChannelObject* ChannelObject)
+		{
+			const SIZE_T Bytes = ChannelObject->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+			ChannelBytes += Bytes;
+			++NumChannels;
+			UE_LOG(LogVivox, Display, TEXT("  %-40s %-14s participants %4d  %8.1f KB"), *ChannelObject->GetChannelSessionId(), *UEnum::GetDisplayValueAsText(ChannelObject->GetChannelType()).ToString(), ChannelObject->GetNumParticipants(), Bytes / 1024.0);
+		});
+	UE_LOG(LogVivox, Display, TEXT("  Subsystem %.1f KB , %d channels %.1f KB , total %.1f KB"), SubsystemBytes / 1024.0, NumChannels, ChannelBytes / 1024.0, (SubsystemBytes + ChannelBytes) / 1024.0);
+}
+
+//Vivox Login Functions
+
+void UVivoxSubSystem::Login(FString PlayerName,FOnVivoxLoggedIn OnLogin)
+{
+	LoginAsync(PlayerName).Then([OnLogin](TFuture<bool> LoggedIn)
+		{
+			OnLogin.ExecuteIfBound(LoggedIn.Get());
+		});
+}
+
+TFuture<bool> UVivoxSubSystem::LoginAsync(const FString& PlayerName, const FVivoxCancellationToken& CancellationToken)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	if (bVivoxDisabled)
+		return VivoxAsync::MakeCompleted(false);
+
+	if (VivoxVoiceClient == nullptr)
+	{
+		UE_LOG(LogVivox, Error, TEXT("Vivox is not initialized cannot login , call InitializeVivox first"));
+		return VivoxAsync::MakeCompleted(false);
+	}
+
+	if (CancellationToken.IsCancelled())
+		return VivoxAsync::MakeCompleted(false);
+
+	//The sdk hands the same session back for the same account , a logout still in progress is finished first
+	FinishLogout();
+
+	if (UsesExternalTokens() && (ExternalLoginToken.Token == "" || ExternalLoginToken.IsExpired()))
+	{
+		UE_LOG(LogVivox, Error, TEXT("No valid server issued login token cannot login , wait for the server to send the tokens"));
+		return VivoxAsync::MakeCompleted(false);
+	}
+
+	if (Credentials.Domain != "" && Credentials.Server != "" && Credentials.TokenIssuer != "" && HasTokenSource() && PlayerName != "")
+	{
+		FVivoxRecordedEvent LoginEvent;
+		LoginEvent.Type = EVivoxRecordedEventType::ApiLogin;
+		LoginEvent.Name = PlayerName;
+		RecordEvent(LoginEvent);
+
+		//Every login is a new metrics session
+		if (MetricsWriter.IsValid())
+		{
+			MetricsWriter->BeginSession();
+		}
+		bSessionSummaryPending = true;
+		SessionReconnects = 0;
+		SessionDeviceFailovers = 0;
+		SessionPeakParticipants = 0;
+		SessionPeakPositionRate = 0.0f;
+		LoginStartTime = FPlatformTime::Seconds();
+
+		//Server issued tokens are bound to the account the server picked
+		FString Useruuid = UsesExternalTokens() ? ExternalLoginToken.AccountName : PlayerName + UVivoxHelperLibrary::GenerateUUID();
+		LoggedInUserId = AccountId(Credentials.TokenIssuer, Useruuid, Credentials.Domain);
+		LoggedInPlayerName = PlayerName;
+		ILoginSession& LoginSessionVivox(VivoxVoiceClient->GetLoginSession(LoggedInUserId));
+		LoginSession = &LoginSessionVivox;
+		FTimespan TokenExpiration = FTimespan::FromSeconds(180);
+		FString LoginToken = UsesExternalTokens() ? ExternalLoginToken.Token : LoginSession->GetLoginToken(Credentials.TokenKey, TokenExpiration);
+		TVivoxAsyncOperationRef<bool> Operation = VivoxAsync::MakeOperation<bool>();
+		ILoginSession::FOnBeginLoginCompletedDelegate OnBeginLoginCompleted;
+		//Weak , the shared client outlives this game instance and can still complete its login
+		OnBeginLoginCompleted.BindWeakLambda(this, [this, Operation](VivoxCoreError Error)
+			{
+				//Cancelled , already logged out
+				if (Operation->IsCompleted())
+					return;
+
+				PendingLoginOperation.Reset();
+				HandleLoginCompleted(Error, FPlatformTime::Seconds() - LoginStartTime, false);
+				Operation->Complete(Error == 0);
+			});
+		PendingLoginOperation = Operation;
+		LoginSession->BeginLogin(Credentials.Server, LoginToken, OnBeginLoginCompleted);
+		CancellationToken.OnCancelled(Operation, [WeakThis = TWeakObjectPtr<UVivoxSubSystem>(this), Operation]()
+			{
+				if (Operation->Complete(false) && WeakThis.IsValid())
+				{
+					WeakThis->Logout();
+				}
+			});
+		return Operation->GetFuture();
+	}
+	else
+	{
+		UE_LOG(LogVivox, Error, TEXT("Provided credentials or player name are empty cannot perform vivox action"));
+		return VivoxAsync::MakeCompleted(false);
+	}
+}
+
+void UVivoxSubSystem::Logout()
+{
+	if (LoginSession != nullptr)
+	{
+		FVivoxRecordedEvent LogoutEvent;
+		LogoutEvent.Type = EVivoxRecordedEventType::ApiLogout;
+		RecordEvent(LogoutEvent);
+
+		//Leaves from all the channels before logging out and clears the registries
+		ClearDesiredChannels();
+		ShutdownAllChannels();
+		RecordSessionSummary();
+		CompletePendingLeaves();
+		LoginSession->Logout();
+		bIsLoggedIn = false;
+		LoginSession = nullptr;
+		if (PendingLoginOperation.IsValid())
+		{
+			CompleteNextTick(PendingLoginOperation.ToSharedRef(), false);
+			PendingLoginOperation.Reset();
+		}
+	}
+	//A logout still spreading over frames is finished now
+	FinishLogout();
+}
+
+void UVivoxSubSystem::BeginLogoutTeardown()
+{
+	FVivoxRecordedEvent LogoutEvent;
+	LogoutEvent.Type = EVivoxRecordedEventType::ApiLogout;
+	RecordEvent(LogoutEvent);
+
+	ClearDesiredChannels();
+	//Channels leave the registries now so nothing new is started on them , they are shut down in batches
+	ForEachChannel([this](UVivoxChannelObject* ChannelObject)
+		{
+			PendingLogoutChannels.Add(ChannelObject);
+		});
+	EchoChannels.Empty();
+	NonPostionalChannels.Empty();
+	PositionalChannels.Empty();
+	ShardedChannels.Empty();
+	ShardSessionIds.Empty();
+	bShardTransmissionActive = false;
+	bChannelBudgetDirty = false;
+
+	RecordSessionSummary();
+	PendingLogoutSession = LoginSession;
+	bIsLoggedIn = false;
+	LoginSession = nullptr;
+	if (PendingLoginOperation.IsValid())
+	{
+		CompleteNextTick(PendingLoginOperation.ToSharedRef(), false);
+		PendingLoginOperation.Reset();
+	}
+}
+
+void UVivoxSubSystem::TickPendingLogout()
+{
+	const int32 NumToRelease = FMath::Min(PendingLogoutChannels.Num(), FMath::Max(GetDefault<UVivoxSettings>()->LogoutChannelsPerFrame, 1));
+	for (int32 Index = 0; Index < NumToRelease; ++Index)
+	{
+		if (IsValid(PendingLogoutChannels[Index]))
+		{
+			PendingLogoutChannels[Index]->ShutdownChannel();
+		}
+	}
+	PendingLogoutChannels.RemoveAt(0, NumToRelease);
+
+	if (PendingLogoutChannels.Num() == 0)
+	{
+		FinishLogout();
+	}
+}
+
+void UVivoxSubSystem::FinishLogout()
+{
+	if (!IsLogoutPending())
+		return;
+
+	for (UVivoxChannelObject* ChannelObject : PendingLogoutChannels)
+	{
+		if (IsValid(ChannelObject))
+		{
+			ChannelObject->ShutdownChannel();
+		}
+	}
+	PendingLogoutChannels.Empty();
+
+	CompletePendingLeaves();
+	PendingLogoutSession->Logout();
+	PendingLogoutSession = nullptr;
+
+	//One collection for everything the logout released
+	if (GEngine)
+	{
+		GEngine->ForceGarbageCollection(true);
+	}
+	UE_LOG(LogVivox, Log, TEXT("Logged out from vivox"));
+
+	TArray<TVivoxAsyncOperationRef<bool>> Operations = MoveTemp(PendingLogoutOperations);
+	PendingLogoutOperations.Reset();
+	for (const TVivoxAsyncOperationRef<bool>& Operation : Operations)
+	{
+		CompleteNextTick(Operation, true);
+	}
+}
+
+void UVivoxSubSystem::BeginLogout(FOnVivoxLoggedOut OnLoggedOut)
+{
+	LogoutAsync().Then([OnLoggedOut](TFuture<bool> LoggedOut)
+		{
+			OnLoggedOut.ExecuteIfBound();
+		});
+}
+
+TFuture<bool> UVivoxSubSystem::LogoutAsync()
+{
+	TVivoxAsyncOperationRef<bool> Operation = VivoxAsync::MakeOperation<bool>();
+	if (LoginSession != nullptr)
+	{
+		BeginLogoutTeardown();
+	}
+
+	if (IsLogoutPending())
+	{
+		PendingLogoutOperations.Add(Operation);
+	}
+	else
+	{
+		CompleteNextTick(Operation, true);
+	}
+	return Operation->GetFuture();
+}
+
+void UVivoxSubSystem::CompleteNextTick(const TVivoxAsyncOperationRef<bool>& Operation, bool bResult)
+{
+	DeferredCompletions.Emplace(Operation, bResult);
+}
+
+int32 UVivoxSubSystem::ShutdownAllChannels()
+{
+	int32 NumReleased = 0;
+	ForEachChannel([&NumReleased](UVivoxChannelObject* ChannelObject)
+		{
+			ChannelObject->ShutdownChannel();
+			++NumReleased;
+		});
+	EchoChannels.Empty();
+	NonPostionalChannels.Empty();
+	PositionalChannels.Empty();
+	ShardedChannels.Empty();
+	ShardSessionIds.Empty();
+	bShardTransmissionActive = false;
+	bChannelBudgetDirty = false;
+
+	if (NumReleased > 0 && GEngine)
+	{
+		GEngine->ForceGarbageCollection(true);
+	}
+	UE_LOG(LogVivox, Log, TEXT("Released %d vivox channels"), NumReleased);
+	return NumReleased;
+}
+
+int32 UVivoxSubSystem::ReleaseChannels(TConstArrayView<UVivoxChannelObject*> Channels)
+{
+	int32 NumReleased = 0;
+	for (UVivoxChannelObject* ChannelObject : Channels)
+	{
+		if (!IsValid(ChannelObject))
+			continue;
+
+		const FString ChannelSessionId = ChannelObject->GetChannelSessionId();
+		TMap<FString, UVivoxChannelObject*>* Registry = GetChannelRegistry(ChannelObject->GetChannelType());
+		if (Registry && Registry->FindRef(ChannelSessionId) == ChannelObject)
+		{
+			Registry->Remove(ChannelSessionId);
+		}
+
+		FVivoxRecordedEvent LeaveEvent;
+		LeaveEvent.Type = EVivoxRecordedEventType::ApiLeaveChannel;
+		LeaveEvent.ChannelType = ChannelObject->GetChannelType();
+		LeaveEvent.ChannelSessionId = ChannelSessionId;
+		RecordEvent(LeaveEvent);
+
+		ChannelObject->ShutdownChannel();
+		if (ChannelObject->GetChannelType() == EVivoxChannelType::NonPositional)
+		{
+			PruneReleasedShard(ChannelSessionId);
+		}
+		++NumReleased;
+	}
+
+	if (NumReleased > 0)
+	{
+		RefreshShardTransmission();
+		MarkChannelBudgetDirty();
+		if (GEngine)
+		{
+			GEngine->ForceGarbageCollection(true);
+		}
+	}
+	return NumReleased;
+}
+
+//Vivox Channel functions
+
+void UVivoxSubSystem::CreateAndJoinVoiceChannel(FString ChannelSessionId, EVivoxChannelType ChannelType, FOnVivoxChannelJoined OnChannelJoined, UVivoxChannelObject*& ChannelObject , bool bConnectAudio, bool bTransmitAudio, bool bConnectText)
+{
+	JoinChannelAsync(ChannelSessionId, ChannelType, bConnectAudio, bTransmitAudio, bConnectText).Then([OnChannelJoined](TFuture<UVivoxChannelObject*> Joined)
+		{
+			OnChannelJoined.ExecuteIfBound(Joined.Get() != nullptr);
+		});
+	//The channel object is registered right away , before the join completes
+	ChannelObject = GetChannelOfType(ChannelType, ChannelSessionId);
+}
+
+TFuture<UVivoxChannelObject*> UVivoxSubSystem::JoinChannelAsync(const FString& ChannelSessionId, EVivoxChannelType ChannelType, bool bConnectAudio, bool bTransmitAudio, bool bConnectText, const FVivoxCancellationToken& CancellationToken)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	if (bVivoxDisabled)
+		return VivoxAsync::MakeCompleted<UVivoxChannelObject*>(nullptr);
+
+	check(ChannelSessionId != "" && Credentials.Domain != "" && Credentials.TokenIssuer != "" && HasTokenSource());
+
+	if (UsesExternalTokens() && FindExternalJoinToken(ChannelType, ChannelSessionId) == nullptr)
+	{
+		UE_LOG(LogVivox, Error, TEXT("No valid server issued join token for channel %s cannot join"), *ChannelSessionId);
+		return VivoxAsync::MakeCompleted<UVivoxChannelObject*>(nullptr);
+	}
+
+	if (ChannelSessionId != "" && Credentials.Domain != "" && Credentials.TokenIssuer != "" && HasTokenSource())
+	{
+		if (LoggedInUserId.IsValid() && bIsLoggedIn)
+		{
+			FVivoxRecordedEvent JoinEvent;
+			JoinEvent.Type = EVivoxRecordedEventType::ApiJoinChannel;
+			JoinEvent.ChannelType = ChannelType;
+			JoinEvent.ChannelSessionId = ChannelSessionId;
+			JoinEvent.Value = (bConnectAudio ? VivoxRecordedAudio_Listen : 0) | (bTransmitAudio ? VivoxRecordedAudio_Transmit : 0) | (bConnectText ? VivoxRecordedAudio_Text : 0);
+			RecordEvent(JoinEvent);
+
+			TMap<FString, UVivoxChannelObject*>* Registry = GetChannelRegistry(ChannelType);
+			if (Registry == nullptr)
+			{
+				UE_LOG(LogVivox, Error, TEXT("Invalid channel type cannot create voice channel"));
+				return VivoxAsync::MakeCompleted<UVivoxChannelObject*>(nullptr);
+			}
+
+			UVivoxChannelObject* VivoxChObj = Registry->FindRef(ChannelSessionId);
+			if (VivoxChObj == nullptr)
+			{
+				VivoxChObj = NewObject<UVivoxChannelObject>(GetGameInstance(), GetChannelClass(ChannelType));
+				Registry->Add(ChannelSessionId, VivoxChObj);
+			}
+			MarkChannelBudgetDirty();
+			return VivoxChObj->JoinChannelAsync(ChannelSessionId, bConnectAudio, bTransmitAudio, bConnectText, CancellationToken)
+				.Then([WeakChannel = TWeakObjectPtr<UVivoxChannelObject>(VivoxChObj)](TFuture<bool> Joined) -> UVivoxChannelObject*
+					{
+						return Joined.Get() ? WeakChannel.Get() : nullptr;
+					});
+		}
+		else
+		{
+			UE_LOG(LogVivox, Error, TEXT("Cannot create voice channel, because not logged in to vivox try login first"));
+			return VivoxAsync::MakeCompleted<UVivoxChannelObject*>(nullptr);
+		}
+	}
+	else
+	{
+		UE_LOG(LogVivox, Error, TEXT("Provided credentials or ChannelSessionId are empty cannot perform vivox action"));
+		return VivoxAsync::MakeCompleted<UVivoxChannelObject*>(nullptr);
+	}
+}
+
+TFuture<bool> UVivoxSubSystem::LeaveChannelAsync(const FString& ChannelSessionId, EVivoxChannelType ChannelType)
+{
+	UVivoxChannelObject* ChannelObject = GetChannelOfType(ChannelType, ChannelSessionId);
+	if (ChannelObject == nullptr)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Cannot leave voice channel %s , it was not joined"), *ChannelSessionId);
+		return VivoxAsync::MakeCompleted(false);
+	}
+
+	return ChannelObject->LeaveChannelAsync();
+}
+
+void UVivoxSubSystem::CompletePendingLeaves()
+{
+	//The login session logging out takes its channel sessions with it , their Disconnected state may never be sent
+	for (const TVivoxAsyncOperationRef<bool>& Operation : PendingLeaveOperations)
+	{
+		CompleteNextTick(Operation, true);
+	}
+	PendingLeaveOperations.Empty();
+}
+
+TArray<UVivoxChannelObject*> UVivoxSubSystem::GetAllChannelOfType(EVivoxChannelType ChannelType) const
+{
+	TArray<UVivoxChannelObject*> ChannelArray;
+	switch (ChannelType)
+	{
+	case EVivoxChannelType::Positional:
+		PositionalChannels.GenerateValueArray(ChannelArray);
+		break;
+	case EVivoxChannelType::NonPositional:
+		NonPostionalChannels.GenerateValueArray(ChannelArray);
+		break;
+	case EVivoxChannelType::Echo:
+		EchoChannels.GenerateValueArray(ChannelArray);
+		break;
+	default:
+		return TArray<UVivoxChannelObject*>();
+	}
+	return ChannelArray;
+}
+
+UVivoxChannelObject* UVivoxSubSystem::GetChannelOfType(EVivoxChannelType ChannelType , FString ChannelSessionId) const
+{
+	switch (ChannelType)
+	{
+	case EVivoxChannelType::Positional:
+		return PositionalChannels.FindRef(ChannelSessionId);;
+	case EVivoxChannelType::NonPositional:
+		return NonPostionalChannels.FindRef(ChannelSessionId);;
+	case EVivoxChannelType::Echo:
+		return EchoChannels.FindRef(ChannelSessionId);;
+	default:
+		return nullptr;
+	}
+}
+
+//Desired channel reconciler
+
+FString UVivoxSubSystem::MakeChannelKey(EVivoxChannelType ChannelType, const FString& ChannelSessionId)
+{
+	return FString::Printf(TEXT("%d:%s"), static_cast<int32>(ChannelType), *ChannelSessionId);
+}
+
+void UVivoxSubSystem::SetDesiredChannels(const TArray<FVivoxDesiredChannel>& Channels)
+{
+	DesiredChannels.Reset();
+	for (const FVivoxDesiredChannel& Channel : Channels)
+	{
+		if (Channel.ChannelSessionId != "")
+		{
+			DesiredChannels.Add(MakeChannelKey(Channel.ChannelType, Channel.ChannelSessionId), Channel);
+		}
+	}
+	//Evicted channels that are still desired stay evicted , rejoining them would only get them evicted again
+	for (auto It = BudgetEvictedChannels.CreateIterator(); It; ++It)
+	{
+		if (!DesiredChannels.Contains(*It))
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = DesiredChannelBackoff.CreateIterator(); It; ++It)
+	{
+		if (!DesiredChannels.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+	bDesiredChannelsActive = true;
+	bDesiredChannelsDirty = true;
+}
+
+void UVivoxSubSystem::ClearDesiredChannels()
+{
+	DesiredChannels.Reset();
+	BudgetEvictedChannels.Reset();
+	DesiredChannelBackoff.Reset();
+	bDesiredChannelsActive = false;
+	bDesiredChannelsDirty = false;
+}
+
+//Sharded channels
+
+int32 UVivoxSubSystem::GetShardCount(int32 ExpectedParticipants)
+{
+	const int32 PerShard = FMath::Max(GetDefault<UVivoxSettings>()->MaxParticipantsPerShard, 2);
+	return FMath::Max(1, FMath::DivideAndRoundUp(ExpectedParticipants, PerShard));
+}
+
+FString UVivoxSubSystem::MakeShardSessionId(const FString& LogicalChannelId, int32 ShardIndex)
+{
+	return FString::Printf(TEXT("%s_shard%d"), *LogicalChannelId, ShardIndex);
+}
+
+void UVivoxSubSystem::JoinShardedChannel(FString LogicalChannelId, FString PlayerId, int32 ExpectedParticipants, bool bDesignatedSpeaker, FOnVivoxChannelJoined OnChannelJoined, bool bTransmitAudio)
+{
+	if (LogicalChannelId == "")
+	{
+		UE_LOG(LogVivox, Error, TEXT("Sharded channel id is empty cannot join"));
+		OnChannelJoined.ExecuteIfBound(false);
+		return;
+	}
+
+	if (!LoggedInUserId.IsValid() || !bIsLoggedIn)
+	{
+		UE_LOG(LogVivox, Error, TEXT("Cannot join sharded channel, because not logged in to vivox try login first"));
+		OnChannelJoined.ExecuteIfBound(false);
+		return;
+	}
+
+	//Shards are picked on the client and moved at runtime , the server never mints join tokens for them
+	if (UsesExternalTokens())
+	{
+		UE_LOG(LogVivox, Error, TEXT("Cannot join sharded channel %s with server issued tokens , assign a non positional channel instead"), *LogicalChannelId);
+		OnChannelJoined.ExecuteIfBound(false);
+		return;
+	}
 
-	if (VivoxVoiceClient != nullptr)
+	if (PlayerId == "")
+	{
+		//The account name carries a new uuid on every login
+		PlayerId = LoggedInPlayerName;
+		UE_LOG(LogVivox, Warning, TEXT("No player id given for sharded channel %s , placing by %s which has to be unique in the room"), *LogicalChannelId, *PlayerId);
+	}
+
+	const int32 ShardCount = GetShardCount(ExpectedParticipants);
+	const int32 HomeShard = UVivoxHelperLibrary::GetChannelShardIndex(PlayerId, ShardCount);
+	FVivoxShardedChannel& Sharded = ShardedChannels.FindOrAdd(LogicalChannelId);
+	//A player already moved past a full shard stays there while the shard count is the same
+	const int32 ShardOffset = (Sharded.ShardCount == ShardCount && Sharded.HomeShard == HomeShard) ? Sharded.ShardOffset : 0;
+
+	TArray<FString> WantedShards;
+	if (bDesignatedSpeaker)
 	{
-		VivoxVoiceClient->Initialize();
+		for (int32 ShardIndex = 0; ShardIndex < ShardCount; ++ShardIndex)
+		{
+			WantedShards.Add(MakeShardSessionId(LogicalChannelId, ShardIndex));
+		}
 	}
 	else
 	{
-		UE_LOG(LogVivox, Error, TEXT("Failed to initialize vivox"));
+		WantedShards.Add(MakeShardSessionId(LogicalChannelId, (HomeShard + ShardOffset) % ShardCount));
+	}
+
+	//Joining again with another size only leaves the shards the player is no longer placed in
+	TArray<FString> ShardsToLeave;
+	for (const FString& ShardId : Sharded.JoinedShards)
+	{
+		if (!WantedShards.Contains(ShardId))
+		{
+			ShardsToLeave.Add(ShardId);
+		}
+	}
+	LeaveShards(ShardsToLeave);
+
+	for (const FString& ShardId : WantedShards)
+	{
+		if (NonPostionalChannels.Contains(ShardId) && Sharded.JoinedShards.Contains(ShardId) && Sharded.bDesignatedSpeaker == bDesignatedSpeaker)
+			continue;
+
+		JoinShard(ShardId, bDesignatedSpeaker, bTransmitAudio, OnChannelJoined);
 	}
+
+	Sharded.ShardCount = ShardCount;
+	Sharded.bDesignatedSpeaker = bDesignatedSpeaker;
+	Sharded.bTransmitAudio = bTransmitAudio;
+	Sharded.HomeShard = HomeShard;
+	Sharded.ShardOffset = ShardOffset;
+	Sharded.JoinedShards = MoveTemp(WantedShards);
+
+	RefreshShardTransmission();
+	UE_LOG(LogVivox, Log, TEXT("Sharded channel %s uses %d shards , joined %d"), *LogicalChannelId, ShardCount, Sharded.JoinedShards.Num());
 }
 
-void UVivoxSubSystem::UnInitializeVivox()
+void UVivoxSubSystem::JoinShard(const FString& ShardId, bool bDesignatedSpeaker, bool bTransmitAudio, FOnVivoxChannelJoined OnChannelJoined)
 {
-	Logout();
-	if (VivoxVoiceClient != nullptr)
+	ShardSessionIds.Add(ShardId);
+	UVivoxChannelObject* ChannelObject = nullptr;
+	//Speaker transmission is set up by RefreshShardTransmission for the whole shard set , switching it to each shard would leave only the last one transmitting
+	CreateAndJoinVoiceChannel(ShardId, EVivoxChannelType::NonPositional, OnChannelJoined, ChannelObject, true, bDesignatedSpeaker ? false : bTransmitAudio);
+	if (ChannelObject && bDesignatedSpeaker)
 	{
-		VivoxVoiceClient->Uninitialize();
+		//Speaker shards carry no transmission of their own so idle suspension would drop them , listeners keep their own setting
+		ChannelObject->SetIdleAudioSuspendEnabled(false);
 	}
-	VivoxVoiceClient = nullptr;
 }
 
-//Vivox Login Functions
-
-void UVivoxSubSystem::Login(FString PlayerName,FOnVivoxLoggedIn OnLogin)
+void UVivoxSubSystem::LeaveShardedChannel(FString LogicalChannelId)
 {
-	check(Credentials.Domain != "" && Credentials.Server != "" && Credentials.TokenIssuer != "" && Credentials.TokenKey != "" && PlayerName != "");
-
-	if (Credentials.Domain != "" && Credentials.Server != "" && Credentials.TokenIssuer != "" && Credentials.TokenKey != "" && PlayerName != "")
+	FVivoxShardedChannel Sharded;
+	if (ShardedChannels.RemoveAndCopyValue(LogicalChannelId, Sharded))
 	{
-		FString Useruuid = PlayerName + UVivoxHelperLibrary::GenerateUUID();
-		LoggedInUserId = AccountId(Credentials.TokenIssuer, Useruuid, Credentials.Domain);
-		ILoginSession& LoginSessionVivox(VivoxVoiceClient->GetLoginSession(LoggedInUserId));
-		LoginSession = &LoginSessionVivox;
-		FTimespan TokenExpiration = FTimespan::FromSeconds(180);
-		FString LoginToken = LoginSession->GetLoginToken(Credentials.TokenKey, TokenExpiration);
-		ILoginSession::FOnBeginLoginCompletedDelegate OnBeginLoginCompleted;
-		OnBeginLoginCompleted.BindLambda([this, OnLogin, &LoginSessionVivox](VivoxCoreError Error)
-			{
-				bIsLoggedIn = (Error == 0) ? true : false;
-				OnLogin.ExecuteIfBound(Error == 0);
-			});
-		LoginSession->BeginLogin(Credentials.Server, LoginToken, OnBeginLoginCompleted);
+		LeaveShards(Sharded.JoinedShards);
+		RefreshShardTransmission();
 	}
-	else
+}
+
+void UVivoxSubSystem::LeaveShards(const TArray<FString>& ShardIds)
+{
+	TArray<UVivoxChannelObject*> ShardChannels;
+	for (const FString& ShardId : ShardIds)
 	{
-		UE_LOG(LogVivox, Error, TEXT("Provided credentials or player name are empty cannot perform vivox action"));
+		ShardSessionIds.Remove(ShardId);
+		if (UVivoxChannelObject* ChannelObject = NonPostionalChannels.FindRef(ShardId))
+		{
+			ShardChannels.Add(ChannelObject);
+		}
 	}
+	ReleaseChannels(ShardChannels);
 }
 
-void UVivoxSubSystem::Logout()
+void UVivoxSubSystem::PruneReleasedShard(const FString& ShardId)
 {
-	if (LoginSession != nullptr)
+	if (!ShardSessionIds.Remove(ShardId))
+		return;
+
+	for (auto It = ShardedChannels.CreateIterator(); It; ++It)
 	{
-		{//Leaves from all the channels before logging out and clears the array
-
-			 EchoChannels;
-			 NonPostionalChannels;
-			 PositionalChannels;
-			 TArray<UVivoxChannelObject*> ObjArray;
-			 EchoChannels.GenerateValueArray(ObjArray);
- 			 for (UVivoxChannelObject* Obj : ObjArray)
-			 {
-				 const FString* Key = EchoChannels.FindKey(Obj);
-				 if (Key)
-				 {
-					 EchoChannels.Remove(*Key);
-					 Obj->LeaveChannel();
-				 }
-			 }
-			 ObjArray.Empty();
-			 NonPostionalChannels.GenerateValueArray(ObjArray);
-			 for (UVivoxChannelObject* Obj : ObjArray)
-			 {
-				 const FString* Key = NonPostionalChannels.FindKey(Obj);
-				 if (Key)
-				 {
-					 NonPostionalChannels.Remove(*Key);
-					 Obj->LeaveChannel();
-				 }
-			 }
-			 ObjArray.Empty();
-			 PositionalChannels.GenerateValueArray(ObjArray);
-			 for (UVivoxChannelObject* Obj : ObjArray)
-			 {
-				 const FString* Key = PositionalChannels.FindKey(Obj);
-				 if (Key)
-				 {
-					 PositionalChannels.Remove(*Key);
-					 Obj->LeaveChannel();
-				 }
-			 }
+		It.Value().JoinedShards.Remove(ShardId);
+		if (It.Value().JoinedShards.Num() == 0)
+		{
+			It.RemoveCurrent();
 		}
-		LoginSession->Logout();
-		bIsLoggedIn = false;
-		LoginSession = nullptr;
-	}	
+	}
 }
 
-//Vivox Channel functions
-
-void UVivoxSubSystem::CreateAndJoinVoiceChannel(FString ChannelSessionId, EVivoxChannelType ChannelType, FOnVivoxChannelJoined OnChannelJoined, UVivoxChannelObject*& ChannelObject , bool bConnectAudio, bool bTransmitAudio)
+void UVivoxSubSystem::EnforceShardCapacity()
 {
-	check(ChannelSessionId != "" && Credentials.Domain != "" && Credentials.TokenIssuer != "" && Credentials.TokenKey != "");
+	const int32 MaxPerShard = FMath::Max(GetDefault<UVivoxSettings>()->MaxParticipantsPerShard, 2);
+	//Left shard , next shard and whether the player transmits in it
+	TArray<TTuple<FString, FString, bool>> Moves;
+	for (TPair<FString, FVivoxShardedChannel>& Pair : ShardedChannels)
+	{
+		FVivoxShardedChannel& Sharded = Pair.Value;
+		if (Sharded.bDesignatedSpeaker || Sharded.JoinedShards.Num() != 1 || Sharded.ShardOffset + 1 >= Sharded.ShardCount)
+			continue;
+
+		const UVivoxChannelObject* ChannelObject = NonPostionalChannels.FindRef(Sharded.JoinedShards[0]);
+		if (!IsValid(ChannelObject) || ChannelObject->GetNumParticipants() <= MaxPerShard)
+			continue;
+
+		//Every client sees the same roster , ranking it by account name moves only the players past the limit
+		TArray<FString> AccountNames;
+		FString SelfName;
+		for (const TPair<FString, FVivoxParticipantState>& Participant : ChannelObject->GetParticipantMap())
+		{
+			AccountNames.Add(Participant.Value.AccountName);
+			if (Participant.Value.bIsSelf)
+			{
+				SelfName = Participant.Value.AccountName;
+			}
+		}
+		AccountNames.Sort();
+		if (SelfName == "" || AccountNames.IndexOfByKey(SelfName) < MaxPerShard)
+			continue;
+
+		++Sharded.ShardOffset;
+		const FString NextShard = MakeShardSessionId(Pair.Key, (Sharded.HomeShard + Sharded.ShardOffset) % Sharded.ShardCount);
+		UE_LOG(LogVivox, Log, TEXT("Shard %s is over %d participants , moving to %s"), *Sharded.JoinedShards[0], MaxPerShard, *NextShard);
+		Moves.Emplace(Sharded.JoinedShards[0], NextShard, Sharded.bTransmitAudio);
+		Sharded.JoinedShards[0] = NextShard;
+	}
 
-	if (ChannelSessionId != "" && Credentials.Domain != "" && Credentials.TokenIssuer != "" && Credentials.TokenKey != "")
+	for (const TTuple<FString, FString, bool>& Move : Moves)
 	{
-		if (LoggedInUserId.IsValid() && bIsLoggedIn)
+		LeaveShards({ Move.Get<0>() });
+		JoinShard(Move.Get<1>(), false, Move.Get<2>(), FOnVivoxChannelJoined());
+	}
+}
+
+void UVivoxSubSystem::RefreshShardTransmission()
+{
+	TArray<UVivoxChannelObject*> SpeakerShards;
+	for (const TPair<FString, FVivoxShardedChannel>& Pair : ShardedChannels)
+	{
+		if (!Pair.Value.bDesignatedSpeaker)
+			continue;
+		for (const FString& ShardId : Pair.Value.JoinedShards)
 		{
-			UVivoxChannelObject* VivoxChObj = nullptr;
-			switch (ChannelType)
+			UVivoxChannelObject* ChannelObject = NonPostionalChannels.FindRef(ShardId);
+			if (IsValid(ChannelObject))
 			{
-			case EVivoxChannelType::Positional:
-				if (PositionalChannels.Contains(ChannelSessionId))
-				{
-					VivoxChObj = PositionalChannels[ChannelSessionId];
-					VivoxChObj->JoinChannel(ChannelSessionId, ChannelType, OnChannelJoined, bConnectAudio, bTransmitAudio);
-				}
-				else
-				{
-					VivoxChObj = NewObject<UVivoxChannelObject>(GetGameInstance());
-					VivoxChObj->JoinChannel(ChannelSessionId, ChannelType, OnChannelJoined, bConnectAudio, bTransmitAudio);
-					PositionalChannels.Add(ChannelSessionId, VivoxChObj);
-				}
-				break;
-			case EVivoxChannelType::NonPositional:
-				if (NonPostionalChannels.Contains(ChannelSessionId))
-				{
-					VivoxChObj = NonPostionalChannels[ChannelSessionId];
-					VivoxChObj->JoinChannel(ChannelSessionId, ChannelType, OnChannelJoined, bConnectAudio, bTransmitAudio);
-				}
-				else
-				{
-					VivoxChObj = NewObject<UVivoxChannelObject>(GetGameInstance());
-					VivoxChObj->JoinChannel(ChannelSessionId, ChannelType, OnChannelJoined, bConnectAudio, bTransmitAudio);
-					NonPostionalChannels.Add(ChannelSessionId, VivoxChObj);
-				}
-				break;
-			case EVivoxChannelType::Echo:
-				if (EchoChannels.Contains(ChannelSessionId))
-				{
-					VivoxChObj = EchoChannels[ChannelSessionId];
-					VivoxChObj->JoinChannel(ChannelSessionId, ChannelType, OnChannelJoined, bConnectAudio, bTransmitAudio);
-				}
-				else
-				{
-					VivoxChObj = NewObject<UVivoxChannelObject>(GetGameInstance());
-					VivoxChObj->JoinChannel(ChannelSessionId, ChannelType, OnChannelJoined, bConnectAudio, bTransmitAudio);
-					EchoChannels.Add(ChannelSessionId, VivoxChObj);
-				}
-				break;
-			default:
-				break;
+				SpeakerShards.Add(ChannelObject);
 			}
-			ChannelObject = VivoxChObj;
 		}
-		else
+	}
+
+	if (LoginSession == nullptr)
+	{
+		bShardTransmissionActive = false;
+		return;
+	}
+
+	if (SpeakerShards.Num() == 0)
+	{
+		if (bShardTransmissionActive)
 		{
-			UE_LOG(LogVivox, Error, TEXT("Cannot create voice channel, because not logged in to vivox try login first"));
-			OnChannelJoined.ExecuteIfBound(false);
+			bShardTransmissionActive = false;
+			LoginSession->SetTransmissionMode(SavedTransmissionMode, SavedTransmissionChannel);
 		}
+		return;
+	}
+
+	if (!bShardTransmissionActive)
+	{
+		bShardTransmissionActive = true;
+		SavedTransmissionMode = LoginSession->GetTransmissionMode();
+		const TArray<ChannelId> TransmittingChannels = LoginSession->GetTransmittingChannels();
+		SavedTransmissionChannel = TransmittingChannels.Num() > 0 ? TransmittingChannels[0] : ChannelId();
+	}
+
+	//The sdk transmits into one channel or into all of them , all is only used while every joined channel is a speaker shard
+	bool bHasOtherChannels = false;
+	ForEachChannel([&SpeakerShards, &bHasOtherChannels](UVivoxChannelObject* ChannelObject)
+		{
+			bHasOtherChannels |= !SpeakerShards.Contains(ChannelObject);
+		});
+
+	if (SpeakerShards.Num() > 1 && !bHasOtherChannels)
+	{
+		LoginSession->SetTransmissionMode(TransmissionMode::All);
 	}
 	else
 	{
-		UE_LOG(LogVivox, Error, TEXT("Provided credentials or ChannelSessionId are empty cannot perform vivox action"));
+		if (SpeakerShards.Num() > 1)
+		{
+			UE_LOG(LogVivox, Warning, TEXT("Designated speaker is in channels outside its shards , transmitting only into %s until they are left"), *SpeakerShards[0]->GetChannelSessionId());
+		}
+		LoginSession->SetTransmissionMode(TransmissionMode::Single, SpeakerShards[0]->GetChannel());
 	}
 }
 
-TArray<UVivoxChannelObject*> UVivoxSubSystem::GetAllChannelOfType(EVivoxChannelType ChannelType) const
+TArray<UVivoxChannelObject*> UVivoxSubSystem::GetShardedChannelObjects(FString LogicalChannelId) const
 {
 	TArray<UVivoxChannelObject*> ChannelArray;
-	switch (ChannelType)
+	if (const FVivoxShardedChannel* Sharded = ShardedChannels.Find(LogicalChannelId))
 	{
-	case EVivoxChannelType::Positional:
-		PositionalChannels.GenerateValueArray(ChannelArray);
-		break;
-	case EVivoxChannelType::NonPositional:
-		NonPostionalChannels.GenerateValueArray(ChannelArray);
-		break;
-	case EVivoxChannelType::Echo:
-		EchoChannels.GenerateValueArray(ChannelArray);
-		break;
-	default:
-		return TArray<UVivoxChannelObject*>();
+		for (const FString& ShardId : Sharded->JoinedShards)
+		{
+			UVivoxChannelObject* ChannelObject = NonPostionalChannels.FindRef(ShardId);
+			if (IsValid(ChannelObject))
+			{
+				ChannelArray.Add(ChannelObject);
+			}
+		}
 	}
 	return ChannelArray;
 }
 
-UVivoxChannelObject* UVivoxSubSystem::GetChannelOfType(EVivoxChannelType ChannelType , FString ChannelSessionId) const
+void UVivoxSubSystem::ReconcileDesiredChannels()
 {
-	switch (ChannelType)
+	if (!bDesiredChannelsActive)
+		return;
+
+	//Wait for login, SetDesiredChannels can be called before it completes
+	if (!bIsLoggedIn || !LoggedInUserId.IsValid())
 	{
-	case EVivoxChannelType::Positional:
-		return PositionalChannels.FindRef(ChannelSessionId);;
-	case EVivoxChannelType::NonPositional:
-		return NonPostionalChannels.FindRef(ChannelSessionId);;
-	case EVivoxChannelType::Echo:
-		return EchoChannels.FindRef(ChannelSessionId);;
-	default:
-		return nullptr;
+		bDesiredChannelsDirty = true;
+		return;
+	}
+
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	const double Now = FPlatformTime::Seconds();
+	TArray<UVivoxChannelObject*> ChannelsToLeave;
+	TSet<FString> LiveKeys;
+	bool bWaitingOnConnect = false;
+	bool bWaitingOnRetry = false;
+
+	ForEachChannel([&](UVivoxChannelObject* ChannelObject)
+		{
+			//Shards are managed by JoinShardedChannel
+			if (ChannelObject->GetChannelType() == EVivoxChannelType::NonPositional && ShardSessionIds.Contains(ChannelObject->GetChannelSessionId()))
+				return;
+
+			//So is the voice self test channel
+			if (ChannelObject == SelfTestChannel.Get())
+				return;
+
+			const FString Key = MakeChannelKey(ChannelObject->GetChannelType(), ChannelObject->GetChannelSessionId());
+
+			//A connect in flight is left alone, the latest desired state is applied once it completes
+			if (ChannelObject->IsConnectPending())
+			{
+				LiveKeys.Add(Key);
+				bWaitingOnConnect = true;
+				return;
+			}
+
+			const FVivoxDesiredChannel* Desired = DesiredChannels.Find(Key);
+			if (Desired == nullptr)
+			{
+				ChannelsToLeave.Add(ChannelObject);
+				return;
+			}
+
+			//A failed or dropped channel counts as missing , it is released and joined again after a backoff
+			if (ChannelObject->IsConnectionLost())
+			{
+				ChannelsToLeave.Add(ChannelObject);
+				FVivoxRejoinBackoff& Backoff = DesiredChannelBackoff.FindOrAdd(Key);
+				++Backoff.Attempts;
+				const float Delay = FMath::Min(Setting->DesiredChannelRetrySeconds * FMath::Pow(2.0f, static_cast<float>(FMath::Min(Backoff.Attempts - 1, 16))), Setting->DesiredChannelMaxRetrySeconds);
+				Backoff.NextAttemptTime = Now + Delay;
+				UE_LOG(LogVivox, Warning, TEXT("Desired channel %s is not connected , joining it again in %.1fs"), *ChannelObject->GetChannelSessionId(), Delay);
+				return;
+			}
+
+			LiveKeys.Add(Key);
+			if (ChannelObject->GetChannelConnectionState() == ConnectionState::Connected)
+			{
+				DesiredChannelBackoff.Remove(Key);
+			}
+
+			if (Desired->bListenAudio != ChannelObject->IsListeningAudio() || Desired->bTransmitAudio != ChannelObject->IsTransmittingAudio())
+			{
+				ChannelObject->SetAudioConnected(Desired->bListenAudio, Desired->bTransmitAudio);
+			}
+			if (Desired->bConnectText != ChannelObject->IsTextRequested())
+			{
+				ChannelObject->SetTextConnected(Desired->bConnectText);
+			}
+		});
+
+	ReleaseChannels(ChannelsToLeave);
+
+	for (const TPair<FString, FVivoxDesiredChannel>& Pair : DesiredChannels)
+	{
+		if (LiveKeys.Contains(Pair.Key) || BudgetEvictedChannels.Contains(Pair.Key))
+			continue;
+
+		//Joined once the server sends its token
+		if (UsesExternalTokens() && FindExternalJoinToken(Pair.Value.ChannelType, Pair.Value.ChannelSessionId) == nullptr)
+			continue;
+
+		const FVivoxRejoinBackoff* Backoff = DesiredChannelBackoff.Find(Pair.Key);
+		if (Backoff != nullptr && Now < Backoff->NextAttemptTime)
+		{
+			bWaitingOnRetry = true;
+			continue;
+		}
+
+		const FVivoxDesiredChannel& Desired = Pair.Value;
+		FOnVivoxChannelJoined OnJoined;
+		OnJoined.BindUFunction(this, GET_FUNCTION_NAME_CHECKED(UVivoxSubSystem, HandleReconcileChannelJoined));
+		UVivoxChannelObject* ChannelObject = nullptr;
+		CreateAndJoinVoiceChannel(Desired.ChannelSessionId, Desired.ChannelType, OnJoined, ChannelObject, Desired.bListenAudio, Desired.bTransmitAudio, Desired.bConnectText);
+	}
+
+	if (bWaitingOnConnect || bWaitingOnRetry)
+	{
+		bDesiredChannelsDirty = true;
+	}
+}
+
+void UVivoxSubSystem::HandleReconcileChannelJoined(bool bJoinSuccessfull)
+{
+	if (!bJoinSuccessfull)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Failed to join a channel of the desired channel set"));
+	}
+	bDesiredChannelsDirty = bDesiredChannelsActive;
+}
+
+//Channel Budget
+
+void UVivoxSubSystem::EnforceChannelBudget()
+{
+	const FVivoxChannelBudget& Budget = GetDefault<UVivoxSettings>()->GetChannelBudget();
+	if (Budget.MaxJoinedChannels <= 0 && Budget.MaxAudioConnectedChannels <= 0)
+		return;
+
+	//Most valuable first, higher priority wins and more recent activity breaks ties
+	TArray<UVivoxChannelObject*> Ranked;
+	ForEachChannel([&Ranked](UVivoxChannelObject* ChannelObject)
+		{
+			Ranked.Add(ChannelObject);
+		});
+	Ranked.Sort([](const UVivoxChannelObject& A, const UVivoxChannelObject& B)
+		{
+			if (A.GetChannelPriority() != B.GetChannelPriority())
+			{
+				return A.GetChannelPriority() > B.GetChannelPriority();
+			}
+			return A.GetLastActivityTime() > B.GetLastActivityTime();
+		});
+
+	if (Budget.MaxJoinedChannels > 0 && Ranked.Num() > Budget.MaxJoinedChannels)
+	{
+		TArray<UVivoxChannelObject*> EvictedChannels;
+		while (Ranked.Num() > Budget.MaxJoinedChannels)
+		{
+			UVivoxChannelObject* Evicted = Ranked.Pop();
+			UE_LOG(LogVivox, Log, TEXT("Leaving channel %s, joined channel budget of %d exceeded"), *Evicted->GetChannelSessionId(), Budget.MaxJoinedChannels);
+			OnChannelBudgetAction.Broadcast(Evicted, EVivoxChannelBudgetAction::Evicted);
+			if (bDesiredChannelsActive)
+			{
+				//Keep the reconciler from joining it straight back
+				BudgetEvictedChannels.Add(MakeChannelKey(Evicted->GetChannelType(), Evicted->GetChannelSessionId()));
+			}
+			EvictedChannels.Add(Evicted);
+		}
+		ReleaseChannels(EvictedChannels);
+	}
+
+	if (Budget.MaxAudioConnectedChannels > 0)
+	{
+		//Walk in value order, the first channels wanting audio keep it and the rest are demoted
+		int32 AudioSlotsLeft = Budget.MaxAudioConnectedChannels;
+		for (UVivoxChannelObject* ChannelObject : Ranked)
+		{
+			if (!ChannelObject->WantsAudioBudget())
+				continue;
+
+			if (AudioSlotsLeft > 0)
+			{
+				--AudioSlotsLeft;
+				if (ChannelObject->IsBudgetDemoted())
+				{
+					ChannelObject->PromoteFromBudget();
+					OnChannelBudgetAction.Broadcast(ChannelObject, EVivoxChannelBudgetAction::Promoted);
+				}
+			}
+			else if (!ChannelObject->IsBudgetDemoted())
+			{
+				ChannelObject->DemoteForBudget();
+				OnChannelBudgetAction.Broadcast(ChannelObject, EVivoxChannelBudgetAction::Demoted);
+			}
+		}
+	}
+	else
+	{
+		for (UVivoxChannelObject* ChannelObject : Ranked)
+		{
+			if (ChannelObject->IsBudgetDemoted())
+			{
+				ChannelObject->PromoteFromBudget();
+				OnChannelBudgetAction.Broadcast(ChannelObject, EVivoxChannelBudgetAction::Promoted);
+			}
+		}
 	}
 }
 
@@ -528,6 +2501,102 @@ TMap<FString, FAudioDeviceData> UVivoxSubSystem::GetAvailableOutputDevices()
 	return TMap<FString, FAudioDeviceData>();
 }
 
+//Voice Profile functions
+
+//Finds a saved device in the already enumerated device list, by id first and by name if the id changed
+static const IAudioDevice* FindAvailableDevice(IAudioDevices& Devices, const FString& DeviceId, const FString& DeviceName)
+{
+	const TMap<FString, IAudioDevice*>& AvailableDevices = Devices.AvailableDevices();
+	if (IAudioDevice* const* Found = AvailableDevices.Find(DeviceId))
+	{
+		return *Found;
+	}
+	for (const TPair<FString, IAudioDevice*>& Pair : AvailableDevices)
+	{
+		if (Pair.Value && (Pair.Value->Id() == DeviceId || (!DeviceName.IsEmpty() && Pair.Value->Name() == DeviceName)))
+		{
+			return Pair.Value;
+		}
+	}
+	return nullptr;
+}
+
+static void ApplyDeviceProfile(IAudioDevices& Devices, const FString& DeviceId, const FString& DeviceName, int32 Volume, bool bMuted)
+{
+	if (!DeviceId.IsEmpty())
+	{
+		Devices.Refresh();
+		if (const IAudioDevice* Device = FindAvailableDevice(Devices, DeviceId, DeviceName))
+		{
+			if (Device->Id() != Devices.ActiveDevice().Id())
+			{
+				Devices.SetActiveDevice(*Device);
+			}
+		}
+		else
+		{
+			UE_LOG(LogVivox, Warning, TEXT("Saved voice device %s is not available , keeping the current device"), *DeviceName);
+		}
+	}
+	Devices.SetVolumeAdjustment(UKismetMathLibrary::MapRangeClamped(Volume, 0, 100, -50, 50));
+	Devices.SetMuted(bMuted);
+}
+
+void UVivoxSubSystem::SaveVoiceProfile()
+{
+	if (VivoxVoiceClient == nullptr)
+	{
+		UE_LOG(LogVivox, Error, TEXT("Vivox is not initialized try initialing it first"));
+		return;
+	}
+
+	IAudioDevices& InputDevices = VivoxVoiceClient->AudioInputDevices();
+	IAudioDevices& OutputDevices = VivoxVoiceClient->AudioOutputDevices();
+
+	UVivoxVoiceProfile* Profile = GetMutableDefault<UVivoxVoiceProfile>();
+	Profile->bHasSavedProfile = true;
+	Profile->InputDeviceId = InputDevices.ActiveDevice().Id();
+	Profile->InputDeviceName = InputDevices.ActiveDevice().Name();
+	Profile->OutputDeviceId = OutputDevices.ActiveDevice().Id();
+	Profile->OutputDeviceName = OutputDevices.ActiveDevice().Name();
+	Profile->InputVolume = FMath::RoundToInt(UKismetMathLibrary::MapRangeClamped(InputDevices.VolumeAdjustment(), -50, 50, 0, 100));
+	Profile->OutputVolume = FMath::RoundToInt(UKismetMathLibrary::MapRangeClamped(OutputDevices.VolumeAdjustment(), -50, 50, 0, 100));
+	Profile->bInputMuted = InputDevices.Muted();
+	Profile->bOutputMuted = OutputDevices.Muted();
+	Profile->SaveConfig();
+}
+
+void UVivoxSubSystem::ApplyVoiceProfile()
+{
+	if (VivoxVoiceClient == nullptr)
+	{
+		UE_LOG(LogVivox, Error, TEXT("Vivox is not initialized try initialing it first"));
+		return;
+	}
+
+	const UVivoxVoiceProfile* Profile = GetDefault<UVivoxVoiceProfile>();
+	if (!Profile->bHasSavedProfile)
+		return;
+
+	ApplyDeviceProfile(VivoxVoiceClient->AudioInputDevices(), Profile->InputDeviceId, Profile->InputDeviceName, Profile->InputVolume, Profile->bInputMuted);
+	ApplyDeviceProfile(VivoxVoiceClient->AudioOutputDevices(), Profile->OutputDeviceId, Profile->OutputDeviceName, Profile->OutputVolume, Profile->bOutputMuted);
+}
+
+void UVivoxSubSystem::ClearVoiceProfile()
+{
+	UVivoxVoiceProfile* Profile = GetMutableDefault<UVivoxVoiceProfile>();
+	Profile->bHasSavedProfile = false;
+	Profile->InputDeviceId.Empty();
+	Profile->InputDeviceName.Empty();
+	Profile->OutputDeviceId.Empty();
+	Profile->OutputDeviceName.Empty();
+	Profile->InputVolume = 50;
+	Profile->OutputVolume = 50;
+	Profile->bInputMuted = false;
+	Profile->bOutputMuted = false;
+	Profile->SaveConfig();
+}
+
 //Transmission functions
 
 bool UVivoxSubSystem::SetTransmissionToNone()
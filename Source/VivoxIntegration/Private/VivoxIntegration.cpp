@@ -3,6 +3,12 @@
 #include "VivoxIntegration.h"
 #include "VivoxSettings.h"
 #include "Developer/Settings/Public/ISettingsModule.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//
+#if WITH_VIVOX_BACKEND
+#include "VivoxCore.h"
+#endif
 
 #define LOCTEXT_NAMESPACE "FVivoxIntegrationModule"
 
@@ -22,6 +28,13 @@ void FVivoxIntegrationModule::StartupModule()
 
 void FVivoxIntegrationModule::ShutdownModule()
 {
+	if (VoiceClientRefCount > 0)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Vivox voice client still has %d users at shutdown , uninitializing it"), VoiceClientRefCount);
+		VoiceClientRefCount = 1;
+		ReleaseVoiceClient();
+	}
+
 	if (ISettingsModule* SettingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings"))
 	{
 		SettingsModule->UnregisterSettings("Project", "Plugins", "Vivox");
@@ -37,6 +50,61 @@ void FVivoxIntegrationModule::ShutdownModule()
 	}
 }
 
+//Shared voice client
+
+IClient* FVivoxIntegrationModule::LoadVoiceClient()
+{
+#if WITH_VIVOX_BACKEND
+	if (SharedVoiceClient == nullptr)
+	{
+		SharedVoiceClient = &FModuleManager::LoadModuleChecked<FVivoxCoreModule>(TEXT("VivoxCore")).VoiceClient();
+	}
+#endif
+	return SharedVoiceClient;
+}
+
+bool FVivoxIntegrationModule::AcquireVoiceClient()
+{
+	check(IsInGameThread());
+	if (LoadVoiceClient() == nullptr)
+		return false;
+
+	++VoiceClientRefCount;
+	if (VoiceClientRefCount > 1)
+	{
+		UE_LOG(LogVivox, Log, TEXT("Sharing the vivox voice client , %d users"), VoiceClientRefCount);
+		return false;
+	}
+
+#if WITH_VIVOX_BACKEND
+	SharedVoiceClient->Initialize();
+#endif
+	UE_LOG(LogVivox, Log, TEXT("Initialized the vivox voice client"));
+	return true;
+}
+
+void FVivoxIntegrationModule::ReleaseVoiceClient()
+{
+	check(IsInGameThread());
+	if (VoiceClientRefCount <= 0)
+	{
+		UE_LOG(LogVivox, Warning, TEXT("Vivox voice client released more times than it was acquired"));
+		return;
+	}
+
+	--VoiceClientRefCount;
+	if (VoiceClientRefCount > 0)
+		return;
+
+#if WITH_VIVOX_BACKEND
+	if (SharedVoiceClient != nullptr)
+	{
+		SharedVoiceClient->Uninitialize();
+	}
+#endif
+	UE_LOG(LogVivox, Log, TEXT("Uninitialized the vivox voice client"));
+}
+
 #undef LOCTEXT_NAMESPACE
 	
 IMPLEMENT_MODULE(FVivoxIntegrationModule, VivoxIntegration)
\ No newline at end of file
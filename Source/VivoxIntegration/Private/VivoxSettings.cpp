@@ -7,4 +7,9 @@
 UVivoxSettings::UVivoxSettings(const FObjectInitializer& ObjectInitializer)
     : Super(ObjectInitializer)
 {
-}
\ No newline at end of file
+}
+const FVivoxChannelBudget& UVivoxSettings::GetChannelBudget() const
+{
+	const FVivoxChannelBudget* PlatformBudget = PlatformChannelBudgets.Find(FString(FPlatformProperties::IniPlatformName()));
+	return PlatformBudget ? *PlatformBudget : DefaultChannelBudget;
+}
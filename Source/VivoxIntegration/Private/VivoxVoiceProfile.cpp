@@ -0,0 +1,10 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "VivoxVoiceProfile.h"
+
+
+UVivoxVoiceProfile::UVivoxVoiceProfile(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+}
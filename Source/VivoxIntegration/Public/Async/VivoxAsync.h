@@ -0,0 +1,163 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+/*
+  Promise of one async vivox operation , completed once by the sdk result or by cancellation whichever comes first
+*/
+template<typename T>
+class TVivoxAsyncOperation
+{
+public:
+	TFuture<T> GetFuture()
+	{
+		return Promise.GetFuture();
+	}
+
+	//Returns false if the operation was already completed
+	bool Complete(const T& Value)
+	{
+		if (bCompleted)
+			return false;
+
+		bCompleted = true;
+		Promise.SetValue(Value);
+		if (OnCompleted)
+		{
+			TFunction<void()> Completed = MoveTemp(OnCompleted);
+			OnCompleted = nullptr;
+			Completed();
+		}
+		return true;
+	}
+
+	bool IsCompleted() const
+	{
+		return bCompleted;
+	}
+
+	//Runs once the operation completes , right away if it already is
+	void SetOnCompleted(TFunction<void()>&& InOnCompleted)
+	{
+		if (bCompleted)
+		{
+			InOnCompleted();
+			return;
+		}
+		OnCompleted = MoveTemp(InOnCompleted);
+	}
+
+private:
+	TPromise<T> Promise;
+	TFunction<void()> OnCompleted;
+	bool bCompleted = false;
+};
+
+template<typename T>
+using TVivoxAsyncOperationRef = TSharedRef<TVivoxAsyncOperation<T>>;
+
+/*
+  Cancel flag shared by copies of the token , hand it to the async vivox calls and cancel it to complete their pending futures with a failure
+  Cancelling also undoes what is in flight (a pending login logs out , a pending join leaves the channel) , late sdk results of cancelled operations are ignored
+  Game thread only
+*/
+class VIVOXINTEGRATION_API FVivoxCancellationToken
+{
+public:
+	FVivoxCancellationToken();
+
+	void Cancel() const;
+	bool IsCancelled() const;
+
+	//Runs OnCancel when the token is cancelled , right away if it already is (the returned handle is then invalid)
+	FDelegateHandle OnCancelled(TFunction<void()>&& OnCancel) const;
+
+	//Drops a callback that is no longer needed , tokens that are never cancelled would keep it forever
+	void RemoveOnCancelled(FDelegateHandle Handle) const;
+
+	//Runs OnCancel when the token is cancelled before Operation completes , the callback is dropped once Operation completes
+	template<typename T>
+	void OnCancelled(const TVivoxAsyncOperationRef<T>& Operation, TFunction<void()>&& OnCancel) const
+	{
+		const FDelegateHandle Handle = OnCancelled(MoveTemp(OnCancel));
+		if (!Handle.IsValid())
+			return;
+
+		//Weak , the operation must not keep the token alive
+		Operation->SetOnCompleted([WeakState = TWeakPtr<FState>(State), Handle]()
+			{
+				if (TSharedPtr<FState> PinnedState = WeakState.Pin())
+				{
+					PinnedState->Callbacks.Remove(Handle);
+				}
+			});
+	}
+
+private:
+	struct FState
+	{
+		bool bCancelled = false;
+		TMap<FDelegateHandle, TFunction<void()>> Callbacks;
+	};
+
+	TSharedRef<FState> State;
+};
+
+namespace VivoxAsync
+{
+	template<typename T>
+	TVivoxAsyncOperationRef<T> MakeOperation()
+	{
+		return MakeShared<TVivoxAsyncOperation<T>>();
+	}
+
+	template<typename T>
+	TFuture<T> MakeCompleted(const T& Value)
+	{
+		return MakeFulfilledPromise<T>(Value).GetFuture();
+	}
+
+	/*
+	  Completes once every future completed , with the results in the order of Futures
+	  The futures are consumed , continuations run on the thread that completed the last future (the game thread for vivox operations)
+	*/
+	template<typename T>
+	TFuture<TArray<T>> WhenAll(TArray<TFuture<T>>&& Futures)
+	{
+		if (Futures.Num() == 0)
+		{
+			return MakeFulfilledPromise<TArray<T>>(TArray<T>()).GetFuture();
+		}
+
+		struct FWhenAllState
+		{
+			TPromise<TArray<T>> Promise;
+			TArray<T> Results;
+			std::atomic<int32> Remaining { 0 };
+		};
+
+		TSharedRef<FWhenAllState, ESPMode::ThreadSafe> WhenAllState = MakeShared<FWhenAllState, ESPMode::ThreadSafe>();
+		WhenAllState->Results.SetNum(Futures.Num());
+		WhenAllState->Remaining = Futures.Num();
+		TFuture<TArray<T>> Result = WhenAllState->Promise.GetFuture();
+
+		for (int32 Index = 0; Index < Futures.Num(); ++Index)
+		{
+			Futures[Index].Then([WhenAllState, Index](TFuture<T> Completed)
+				{
+					WhenAllState->Results[Index] = Completed.Get();
+					if (--WhenAllState->Remaining == 0)
+					{
+						WhenAllState->Promise.SetValue(MoveTemp(WhenAllState->Results));
+					}
+				});
+		}
+		return Result;
+	}
+
+	//Completes with true once every future completed , false if any of them failed
+	VIVOXINTEGRATION_API TFuture<bool> WhenAllSucceeded(TArray<TFuture<bool>>&& Futures);
+}
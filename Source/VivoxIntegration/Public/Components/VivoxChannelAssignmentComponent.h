@@ -0,0 +1,155 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//
+#include "VivoxChannelAssignmentComponent.generated.h"
+
+class UVivoxChannelAssignmentComponent;
+
+//One channel the server assigned to the player
+USTRUCT(BlueprintType)
+struct FVivoxChannelAssignment : public FFastArraySerializerItem
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	FString ChannelSessionId;
+
+	UPROPERTY(BlueprintReadOnly)
+	EVivoxChannelType ChannelType = EVivoxChannelType::NonPositional;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bListenAudio = true;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bTransmitAudio = true;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bConnectText = false;
+};
+
+//Assigned channels , only the changed entries are sent to the owning client
+USTRUCT()
+struct FVivoxChannelAssignmentArray : public FFastArraySerializer
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TArray<FVivoxChannelAssignment> Items;
+
+	UPROPERTY(NotReplicated)
+	UVivoxChannelAssignmentComponent* OwnerComponent = nullptr;
+
+	//Called once after every replicated update , however many entries it changed
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FVivoxChannelAssignment, FVivoxChannelAssignmentArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FVivoxChannelAssignmentArray> : public TStructOpsTypeTraitsBase2<FVivoxChannelAssignmentArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVivoxChannelAssignmentsApplied, const TArray<FVivoxDesiredChannel>&, Channels);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnVivoxServerAssignmentsChanged, UVivoxChannelAssignmentComponent*);
+
+/*
+  Server owned voice channel membership of one player , add it to the player controller (or a pawn owned by it)
+  The server assigns channels , the owning client receives the changes and applies the whole set to the VivoxSubSystem as its desired channels in one batch
+  While the component is active it owns SetDesiredChannels of the local player
+*/
+UCLASS(ClassGroup = (Vivox), meta = (BlueprintSpawnableComponent))
+class VIVOXINTEGRATION_API UVivoxChannelAssignmentComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UVivoxChannelAssignmentComponent();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//Server
+
+	/*
+	  Assigns a channel to the player or changes the audio of an assigned channel , server only
+	  @param ChannelSessionId Channel Id to identify Voice channel
+	  @param ChannelType Voice Channel Type
+	  @param bListenAudio if true the player hears the channel
+	  @param bTransmitAudio if true the player speaks in the channel
+	  @param bConnectText if true the player can send and receive text messages in the channel
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Vivox|Assignment")
+	void AssignChannel(const FString& ChannelSessionId, EVivoxChannelType ChannelType, bool bListenAudio = true, bool bTransmitAudio = true, bool bConnectText = false);
+
+	/*
+	  Removes a channel from the player , server only
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Vivox|Assignment")
+	void UnassignChannel(const FString& ChannelSessionId, EVivoxChannelType ChannelType);
+
+	/*
+	  Removes every channel from the player , server only
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Vivox|Assignment")
+	void ClearAssignedChannels();
+
+	//Called on the server when a player began play or its assignment changed , the token issuer mints the player's tokens from it
+	static FOnVivoxServerAssignmentsChanged OnServerAssignmentsChanged;
+
+	//Vivox account of the player , picked by the server and delivered with the login token
+	const FString& GetOrCreateVivoxAccountName();
+
+	//Sends tokens minted by the server to the owning client
+	void SendVivoxTokens(const TArray<FVivoxIssuedToken>& Tokens);
+
+	//Both
+
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Channels"), Category = "Vivox|Assignment")
+	TArray<FVivoxDesiredChannel> GetAssignedChannels() const;
+
+	//Called on the owning client after an update was applied to the VivoxSubSystem
+	UPROPERTY(BlueprintAssignable, Category = "Vivox|Assignment")
+	FOnVivoxChannelAssignmentsApplied OnAssignmentsApplied;
+
+	//Client
+
+	//Gives the whole assignment to the VivoxSubSystem of the local player
+	void ApplyAssignments();
+
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveVivoxTokens(const TArray<FVivoxIssuedToken>& Tokens);
+
+protected:
+
+	virtual void BeginPlay() override;
+
+private:
+
+	UPROPERTY(Replicated)
+	FVivoxChannelAssignmentArray Assignments;
+
+	//Set while an apply for the listen server host is queued for the next tick
+	bool bLocalApplyPending = false;
+
+	//Server only
+	FString VivoxAccountName;
+
+	int32 FindAssignment(const FString& ChannelSessionId, EVivoxChannelType ChannelType) const;
+	bool IsLocallyControlled() const;
+	void OnAssignmentsChanged();
+};
@@ -0,0 +1,27 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCanvas;
+class APlayerController;
+class UVivoxSubSystem;
+class UVivoxChannelObject;
+
+/*
+  On screen overlay listing every voice channel of a VivoxSubSystem , it only reads state the channels already cache so drawing it never calls into the vivox sdk
+*/
+class VIVOXINTEGRATION_API FVivoxDebugHud
+{
+public:
+	explicit FVivoxDebugHud(UVivoxSubSystem* InSubsystem);
+	~FVivoxDebugHud();
+
+private:
+	TWeakObjectPtr<UVivoxSubSystem> Subsystem;
+	FDelegateHandle DrawHandle;
+
+	void Draw(UCanvas* Canvas, APlayerController* PlayerController);
+	float DrawChannel(UCanvas* Canvas, const UVivoxChannelObject* ChannelObject, float X, float Y) const;
+};
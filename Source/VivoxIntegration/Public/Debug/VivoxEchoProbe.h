@@ -0,0 +1,90 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//
+
+class UVivoxChannelObject;
+
+/*
+  Correlates local speech onsets with the audio returned by an echo channel.
+  An echo channel only has the self participant , the echo played back is picked up by the microphone and shows up as a second burst of self energy after a pause , so both are read from the self participant updates and the latency includes capture , network , server and playback
+*/
+class VIVOXINTEGRATION_API FVivoxEchoProbe
+{
+public:
+	FVivoxEchoProbe(float InReturnEnergyThreshold, float InClipEnergy, float InMaxRoundTripSeconds);
+
+	//Update of the self participant , a burst starting while an onset waits for its echo is that echo , any other burst is a new onset
+	void AddSelfSample(double Time, bool bSpeechDetected, double Energy);
+
+	//Onsets older than the max round trip are counted as missed
+	void ExpirePendingOnsets(double Time);
+
+	FVivoxSelfTestResult GetResult(double Time) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	float ReturnEnergyThreshold;
+	float ClipEnergy;
+	double MaxRoundTripSeconds;
+	double StartTime;
+
+	//Onset times waiting for their echo , oldest first
+	TArray<double> PendingOnsets;
+	TArray<float> RoundTripsMs;
+	int32 MissedRoundTrips = 0;
+
+	bool bSelfActive = false;
+	//True while the current burst is an echo , its samples are not input level
+	bool bEchoBurst = false;
+
+	double InputLevelSum = 0.0;
+	int32 InputLevelSamples = 0;
+	float InputLevelPeak = 0.0f;
+	int32 ClippedSamples = 0;
+};
+
+/*
+  Offline stand in for the vivox backend , drives an echo channel with a synthetic talker that says short words with pauses.
+  Like the real echo channel there is only the self participant , the echo comes back as self energy after a simulated latency
+*/
+class VIVOXINTEGRATION_API FVivoxLoopbackEchoSource
+{
+public:
+	FVivoxLoopbackEchoSource(UVivoxChannelObject* InChannel, float InLatencySeconds, float InJitterSeconds);
+
+	//Connects the channel and adds the self participant
+	void Start(double Time);
+
+	void Tick(double Time);
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FPendingReturn
+	{
+		double Time = 0.0;
+		bool bSpeechDetected = false;
+		double Energy = 0.0;
+	};
+
+	TWeakObjectPtr<UVivoxChannelObject> Channel;
+	float LatencySeconds;
+	float JitterSeconds;
+
+	FVivoxParticipantState Self;
+
+	//Returns in the order they were sent , like a single audio stream
+	TArray<FPendingReturn> PendingReturns;
+	FPendingReturn CurrentReturn;
+	double LastReturnTime = 0.0;
+
+	bool bTalking = false;
+	double NextToggleTime = 0.0;
+	double NextUpdateTime = 0.0;
+};
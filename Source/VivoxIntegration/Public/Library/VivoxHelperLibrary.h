@@ -16,4 +16,15 @@ class VIVOXINTEGRATION_API UVivoxHelperLibrary : public UBlueprintFunctionLibrar
 	
 public:
 	static FString GenerateUUID();
+
+	//Jump consistent hash , maps Key to a bucket in [0, NumBuckets) and only moves 1/NumBuckets of the keys when a bucket is added
+	static int32 JumpConsistentHash(uint64 Key, int32 NumBuckets);
+
+	/*
+	  Gets the shard of a sharded channel a player is placed in , every client computes the same shard for the same player
+	  @param PlayerId Id of the player that stays the same across logins (platform or backend user id)
+	  @param ShardCount Number of shards of the channel
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "ShardIndex"), Category = "Vivox|VoiceChannel|Sharding")
+	static int32 GetChannelShardIndex(const FString& PlayerId, int32 ShardCount);
 };
@@ -0,0 +1,69 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include <atomic>
+
+class FRunnableThread;
+class IFileHandle;
+
+using FVivoxMetricsJsonWriter = TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>;
+
+/*
+  Appends voice performance records as newline delimited json from a background thread.
+  Records are formatted on the calling thread and queued , once the queue is full new records are dropped and the drop count is written with the next record.
+  The file is rotated once it grows past the size limit , keeping a fixed number of older files
+*/
+class VIVOXINTEGRATION_API FVivoxMetricsWriter : public FRunnable
+{
+public:
+	FVivoxMetricsWriter(const FString& InDirectory, const FString& InFileName, int32 InMaxQueuedRecords, int64 InMaxFileBytes, int32 InMaxFiles);
+	virtual ~FVivoxMetricsWriter() override;
+
+	//Starts a new session , every record carries the session id and the seconds since the session started
+	void BeginSession();
+
+	/*
+	  Queues one record
+	  @param Event Record type
+	  @param Fill Writes the record fields , only run when the record is queued
+	*/
+	void Record(const TCHAR* Event, TFunctionRef<void(FVivoxMetricsJsonWriter&)> Fill);
+	void Record(const TCHAR* Event);
+
+	const FString& GetSessionId() const { return SessionId; }
+
+	//FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	FString Directory;
+	//File name without extension , rotated files get .1 , .2 ...
+	FString FileName;
+	int32 MaxQueuedRecords;
+	int64 MaxFileBytes;
+	int32 MaxFiles;
+
+	FString SessionId;
+	double SessionStartTime = 0.0;
+
+	FCriticalSection QueueLock;
+	TArray<FString> Queue;
+	int32 DroppedRecords = 0;
+
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopping { false };
+
+	//Only touched by the writer thread
+	TUniquePtr<IFileHandle> File;
+
+	FString GetFilePath(int32 Index) const;
+	void WriteQueued();
+	void RotateFiles();
+};
@@ -6,6 +6,10 @@
 #include "UObject/NoExportTypes.h"
 //Resource
 #include "Resource/VivoxResource.h"
+#include "Resource/VivoxRingBuffer.h"
+//
+//Async
+#include "Async/VivoxAsync.h"
 //
 //Vivox
 
@@ -14,6 +18,9 @@
 //
 #include "VivoxChannelObject.generated.h"
 
+enum class EVivoxRecordedEventType : uint8;
+struct FVivoxRecordedEvent;
+
 //For Positional Channel
 template<class T>
 class CachedProperty
@@ -48,25 +55,130 @@ protected:
 };
 
 
-UCLASS(BlueprintType)
+/*
+  Base of the voice channel objects , UVivoxSubSystem creates the subclass matching the channel type
+  (UVivoxPositionalChannelObject , UVivoxNonPositionalChannelObject , UVivoxEchoChannelObject) so type specific state and code only exist where they are used
+*/
+UCLASS(Abstract, BlueprintType)
 class VIVOXINTEGRATION_API UVivoxChannelObject : public UObject
 {
 	GENERATED_BODY()
 	
-private:
+protected:
 
 	IChannelSession* ChannelSession = nullptr;
 
 	//Channel property 
-	EVivoxChannelType CurrentChannelType;
 	FString CurrentChannelSessionId;
+	//Same id as a name for the voice state snapshot , built once per join
+	FName CurrentChannelSessionName;
+
+	//Builds the sdk channel id for this channel type
+	virtual ChannelId MakeChannelId(const FString& TokenIssuer, const FString& ChannelSessionId, const FString& Domain) const PURE_VIRTUAL(UVivoxChannelObject::MakeChannelId, return ChannelId(););
+
+	//True for channel types idle audio suspension applies to
+	virtual bool SupportsIdleSuspend() const { return false; }
 
-	//Currently not using
+	//Called after a roster entry was updated
+	virtual void OnParticipantUpdated(const FVivoxParticipantState& Participant) {}
+
+	//Adds an event of this channel to the subsystem event recording, Fill is only run while recording
+	void RecordEvent(EVivoxRecordedEventType Type, TFunctionRef<void(FVivoxRecordedEvent&)> Fill) const;
+	void RecordEvent(EVivoxRecordedEventType Type) const;
+
+private:
+
+	//Audio state requested by the user, the connected state can differ while the channel is idle suspended
 	bool bTransmittingAudio = false;
 	bool bListeningAudio = false;
 
+	//True between BeginConnect and its completion
+	bool bConnectPending = false;
+
+	//True if the last connect failed
+	bool bConnectFailed = false;
+
+	//Set up by InitializeForReplay , state changes are applied without a channel session
+	bool bOfflineChannel = false;
+
+	//Time from BeginConnect to its completion , shown on the debug hud
+	double JoinStartTime = 0.0;
+	float LastJoinLatencySeconds = -1.0f;
+
+	//Join in flight , failed when the channel is shut down before it connects
+	TSharedPtr<TVivoxAsyncOperation<bool>> PendingJoinOperation;
+
+	//Set by LeaveChannelAsync , handed to the channel session in ShutdownChannel and completed once it reports Disconnected
+	TSharedPtr<TVivoxAsyncOperation<bool>> PendingLeaveOperation;
+
+	//Session metrics
+	double ConnectedTime = 0.0;
+	int32 PeakParticipants = 0;
+
 	//Participant 
-	IParticipant* CurrentParticipant;
+	IParticipant* CurrentParticipant = nullptr;
+
+	//Roster of the channel keyed by participant id
+	TMap<FString, FVivoxParticipantState> Participants;
+
+	//Idle audio suspension
+	bool bIdleSuspendEnabled = true;
+	bool bAudioIdleSuspended = false;
+	bool bTextConnectedForSuspend = false;
+	double LastSpeechActivityTime = 0.0;
+	double IdleSuspendedTime = 0.0;
+
+	//Channel budget
+	int32 Priority = 0;
+	bool bBudgetDemoted = false;
+
+	//Text
+	bool bTextRequested = false;
+	TVivoxRingBuffer<FVivoxTextMessage> TextHistory;
+	TArray<FVivoxTextMessage> PendingInboundMessages;
+	TArray<FString> OutboundTextQueue;
+	float TextSendTokens = 0.0f;
+	bool bTextSendInFlight = false;
+
+	void OnTextMessageReceived(const IChannelTextMessage& TextMessage);
+	void FlushOutboundText(float DeltaTime);
+
+	//Channel session event handles
+	FDelegateHandle TextMessageReceivedHandle;
+	FDelegateHandle ParticipantAddedHandle;
+	FDelegateHandle ParticipantUpdatedHandle;
+	FDelegateHandle ParticipantRemovedHandle;
+	FDelegateHandle ChannelStateChangedHandle;
+	FDelegateHandle AudioStateChangedHandle;
+	FDelegateHandle TextStateChangedHandle;
+
+	void BindChannelSessionEvents();
+	void UnbindChannelSessionEvents();
+
+	void OnParticipantAdded(const IParticipant& Participant);
+	void OnParticipantUpdated(const IParticipant& Participant);
+	void OnParticipantRemoved(const IParticipant& Participant);
+
+	//Connection state cached from the channel session events so reading it never calls into the sdk
+	ConnectionState CachedChannelState = ConnectionState::Disconnected;
+	ConnectionState CachedAudioState = ConnectionState::Disconnected;
+	ConnectionState CachedTextState = ConnectionState::Disconnected;
+
+	void OnSessionChannelStateChanged(const IChannelConnectionState& State);
+	void OnSessionAudioStateChanged(const IChannelConnectionState& State);
+	void OnSessionTextStateChanged(const IChannelConnectionState& State);
+	void ResetConnectionStates();
+
+	bool CanIdleSuspend() const;
+	void SuspendAudioForIdle();
+	void ResumeAudioFromIdle();
+
+	//Drops audio while keeping the channel joined through text, used by idle suspension and budget demotion
+	void DisconnectAudioKeepText();
+	void ReconnectAudio();
+
+	class UVivoxSubSystem* GetVivoxSubsystem() const;
+	void MarkChannelBudgetDirty() const;
 
 public:
 
@@ -76,13 +188,43 @@ public:
 	  Get SessionId of current channel
 	*/
 	UFUNCTION(BlueprintPure, Category = "Vivox|VoiceChannel", meta= (Keywords = "Id Session Channel", ReturnDisplayName = "ChannelSessionId"), BlueprintCosmetic)
-	FString GetChannelSessionId() { return CurrentChannelSessionId; };
+	FString GetChannelSessionId() const { return CurrentChannelSessionId; };
+
+	FName GetChannelSessionName() const { return CurrentChannelSessionName; }
 
 	/*
 	  Get connection state of current channel
 	*/
 	UFUNCTION(BlueprintPure, meta = (Keywords = "Channel", ReturnDisplayName = "ConnectionState"),Category = "Vivox|VoiceChannel",BlueprintCosmetic)
-	ConnectionState GetChannelConnectionState();
+	ConnectionState GetChannelConnectionState() const { return CachedChannelState; }
+
+	/*
+	  Get audio connection state of current channel
+	*/
+	UFUNCTION(BlueprintPure, meta = (Keywords = "Channel Audio", ReturnDisplayName = "ConnectionState"),Category = "Vivox|VoiceChannel",BlueprintCosmetic)
+	ConnectionState GetAudioConnectionState() const { return CachedAudioState; }
+
+	/*
+	  Get text connection state of current channel
+	*/
+	UFUNCTION(BlueprintPure, meta = (Keywords = "Channel Text", ReturnDisplayName = "ConnectionState"),Category = "Vivox|VoiceChannel|Text",BlueprintCosmetic)
+	ConnectionState GetTextConnectionState() const { return CachedTextState; }
+
+	//Called when the connection state of the channel changes
+	UPROPERTY(BlueprintAssignable, Category = "Vivox|VoiceChannel")
+	FOnVivoxConnectionStateChanged OnChannelStateChanged;
+
+	//Called when the audio connection state of the channel changes
+	UPROPERTY(BlueprintAssignable, Category = "Vivox|VoiceChannel")
+	FOnVivoxConnectionStateChanged OnAudioStateChanged;
+
+	//Called when the text connection state of the channel changes
+	UPROPERTY(BlueprintAssignable, Category = "Vivox|VoiceChannel|Text")
+	FOnVivoxConnectionStateChanged OnTextStateChanged;
+
+	void HandleChannelStateChanged(ConnectionState State);
+	void HandleAudioStateChanged(ConnectionState State);
+	void HandleTextStateChanged(ConnectionState State);
 
 	/*
 	  Set the audio and transmission state for channel
@@ -92,7 +234,28 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel", meta = (Keywords = "Audio Listen Transmission"), BlueprintCosmetic)
 	void SetAudioConnected(bool bListenAudio=true,bool bTransmitAudio=true);
 
-	void JoinChannel(FString ChannelId, EVivoxChannelType ChannelType , FOnVivoxChannelJoined OnChannelJoined, bool bConnectAudio = true, bool bTransmitAudio = true);
+	//Requested audio and text state, used by the channel reconciler
+	bool IsListeningAudio() const { return bListeningAudio; }
+	bool IsTransmittingAudio() const { return bTransmittingAudio; }
+	bool IsTextRequested() const { return bTextRequested; }
+	bool IsConnectPending() const { return bConnectPending; }
+
+	//True if the connect failed or the sdk gave up on the connected channel , the channel has to be joined again
+	bool IsConnectionLost() const { return !bConnectPending && (bConnectFailed || (ConnectedTime > 0.0 && CachedChannelState == ConnectionState::Disconnected)); }
+	virtual EVivoxChannelType GetChannelType() const PURE_VIRTUAL(UVivoxChannelObject::GetChannelType, return EVivoxChannelType::NonPositional;);
+
+	//True for channels set up by InitializeForReplay (event replay , self test loopback)
+	bool IsOfflineChannel() const { return bOfflineChannel; }
+
+	//Sets the channel up without a channel session so recorded events can be replayed into it
+	void InitializeForReplay(const FString& ChannelSessionId, bool bConnectAudio, bool bTransmitAudio, bool bConnectText);
+
+	void HandleConnectCompleted(bool bSuccess);
+
+	void JoinChannel(FString ChannelId, FOnVivoxChannelJoined OnChannelJoined, bool bConnectAudio = true, bool bTransmitAudio = true, bool bConnectText = false);
+
+	//Connects the channel , the future completes with the connect result on the game thread
+	TFuture<bool> JoinChannelAsync(const FString& ChannelId, bool bConnectAudio = true, bool bTransmitAudio = true, bool bConnectText = false, const FVivoxCancellationToken& CancellationToken = FVivoxCancellationToken());
 
 	/*
 	  Leaves the current channel and destroys the object (Use CreateAndJoinChannelVoiceChannel from VivoxSubSystem to join the same channel again) 
@@ -100,25 +263,133 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel", BlueprintCosmetic)
 	void LeaveChannel();
 
-	//Positional Channel Property 
+	//Same as LeaveChannel , the future completes once the sdk reports the channel disconnected (next frame without a channel session)
+	TFuture<bool> LeaveChannelAsync();
 
-	CachedProperty<FVector> CachedPosition = CachedProperty<FVector>(FVector());
-	CachedProperty<FVector> CachedForwardVector = CachedProperty<FVector>(FVector());
-	CachedProperty<FVector> CachedUpVector = CachedProperty<FVector>(FVector());
-	bool Get3DValuesAreDirty() const;
-	void Clear3DValuesAreDirty();
+	//Disconnects the channel session and releases the channel without touching the channel registry or collecting garbage , used by the subsystem bulk teardown
+	void ShutdownChannel();
 
 	/*
-	  Sets the position of player in 3d world space for positional channel
+	  Sets the position of player in 3d world space for positional channel , only positional channels implement it
 	  @param position Actor Location
 	  @param ForwardVector Actor Forward Vector
 	  @param UpVector Actor UpVector
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Positional", meta = (Keywords = "Channel Position Location Transform"), BlueprintCosmetic)
-	void UpdateVivox3dPosition(const FVector& position, const FVector& ForwardVector, const FVector& UpVector);
+	virtual void UpdateVivox3dPosition(const FVector& position, const FVector& ForwardVector, const FVector& UpVector);
 
 	//Used to check if currently speaking to channel or not 
 	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "IsSpeaking"),Category = "Vivox|VoiceChannel")
 	bool IsSpeakingToChannel(double& AudioEnergy) const;
 
+	//Roster
+
+	/*
+	  Gets all participants currently in the channel
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Participants"), Category = "Vivox|VoiceChannel", BlueprintCosmetic)
+	TArray<FVivoxParticipantState> GetParticipants() const;
+
+	void HandleParticipantAdded(const FVivoxParticipantState& Participant);
+	void HandleParticipantUpdated(const FVivoxParticipantState& Participant);
+	void HandleParticipantRemoved(const FVivoxParticipantState& Participant);
+
+	//Idle audio suspension
+
+	/*
+	  Enables or disables idle audio suspension for this channel, only used for non positional channels when it is enabled in vivox settings
+	  @param bEnabled if false the channel keeps its audio connected even when nobody speaks
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|IdleSuspend", BlueprintCosmetic)
+	void SetIdleAudioSuspendEnabled(bool bEnabled);
+
+	/*
+	  Returns true if the audio of this channel is currently dropped because nobody spoke in it
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "IsSuspended"), Category = "Vivox|VoiceChannel|IdleSuspend", BlueprintCosmetic)
+	bool IsAudioIdleSuspended() const { return bAudioIdleSuspended; }
+
+	/*
+	  Reconnects the audio of an idle suspended channel right away (call it from push to talk before transmitting into the channel)
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|IdleSuspend", BlueprintCosmetic)
+	void WakeFromIdle();
+
+	//Text
+
+	//Called once per frame with every text message received in the channel since the last frame
+	UPROPERTY(BlueprintAssignable, Category = "Vivox|VoiceChannel|Text")
+	FOnVivoxTextMessagesReceived OnTextMessagesReceived;
+
+	/*
+	  Connects or disconnects text for channel, text must be connected to send and receive messages
+	  @param bConnectText True to add text, false to remove text
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Text", BlueprintCosmetic)
+	void SetTextConnected(bool bConnectText = true);
+
+	/*
+	  Queues a text message for the channel, messages are rate limited and queued messages are merged into one send
+	  @param Message Message to send
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Text", BlueprintCosmetic)
+	void SendTextMessage(const FString& Message);
+
+	/*
+	  Gets the last received messages of the channel from oldest to newest
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Messages"), Category = "Vivox|VoiceChannel|Text", BlueprintCosmetic)
+	TArray<FVivoxTextMessage> GetTextHistory() const;
+
+	void HandleTextMessageReceived(const FVivoxTextMessage& TextMessage);
+
+	//Channel budget
+
+	/*
+	  Sets the priority used by the channel budget, when too many channels are connected the lowest priority and least recently active channels lose their audio first
+	  @param NewPriority Higher value keeps the channel connected longer
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Budget", BlueprintCosmetic)
+	void SetChannelPriority(int32 NewPriority);
+
+	/*
+	  Gets the priority used by the channel budget
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Priority"), Category = "Vivox|VoiceChannel|Budget", BlueprintCosmetic)
+	int32 GetChannelPriority() const { return Priority; }
+
+	/*
+	  Returns true if the channel audio is dropped because the audio channel budget is full
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "IsDemoted"), Category = "Vivox|VoiceChannel|Budget", BlueprintCosmetic)
+	bool IsBudgetDemoted() const { return bBudgetDemoted; }
+
+	//Time of the last speech, join or audio change in FPlatformTime::Seconds
+	double GetLastActivityTime() const { return LastSpeechActivityTime; }
+
+	//True if the channel would take one slot of the audio channel budget when not demoted
+	bool WantsAudioBudget() const;
+
+	//True if the channel currently takes one slot of the audio channel budget
+	bool UsesAudioBudget() const;
+
+	void DemoteForBudget();
+	void PromoteFromBudget();
+
+	//Called every frame by the VivoxSubSystem
+	virtual void TickChannel(float DeltaTime);
+
+	int32 GetNumParticipants() const { return Participants.Num(); }
+	const TMap<FString, FVivoxParticipantState>& GetParticipantMap() const { return Participants; }
+
+	//Seconds the last join took to complete , negative while no join completed
+	float GetLastJoinLatency() const { return LastJoinLatencySeconds; }
+
+	//Set3DPosition calls per second sent to the sdk , only positional channels send them
+	virtual float GetPositionUpdateRate() const { return 0.0f; }
+
+	//UObject
+
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 };
@@ -0,0 +1,50 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Objects/VivoxChannelObject.h"
+//Debug
+#include "Debug/VivoxEchoProbe.h"
+//
+#include "VivoxEchoChannelObject.generated.h"
+
+/*
+  Echo voice channel , plays the player's own voice back to them
+*/
+UCLASS(BlueprintType)
+class VIVOXINTEGRATION_API UVivoxEchoChannelObject : public UVivoxChannelObject
+{
+	GENERATED_BODY()
+
+private:
+
+	//Self test , only exists while a probe runs on this channel
+	TUniquePtr<FVivoxEchoProbe> Probe;
+	TUniquePtr<FVivoxLoopbackEchoSource> Loopback;
+
+protected:
+
+	virtual ChannelId MakeChannelId(const FString& TokenIssuer, const FString& ChannelSessionId, const FString& Domain) const override;
+
+	virtual void OnParticipantUpdated(const FVivoxParticipantState& Participant) override;
+
+public:
+
+	virtual EVivoxChannelType GetChannelType() const override { return EVivoxChannelType::Echo; }
+
+	//Self test
+
+	/*
+	  Starts measuring round trip latency and input level on this channel
+	  @param bUseLoopback True if the channel has no channel session and the local loopback stand in should drive it
+	*/
+	void StartProbe(bool bUseLoopback);
+	void StopProbe();
+	bool IsProbing() const { return Probe.IsValid(); }
+	FVivoxSelfTestResult GetProbeResult() const;
+
+	virtual void TickChannel(float DeltaTime) override;
+
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+};
@@ -0,0 +1,26 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Objects/VivoxChannelObject.h"
+#include "VivoxNonPositionalChannelObject.generated.h"
+
+/*
+  Non positional voice channel (team , party , lobby) , everyone is heard at the same volume
+*/
+UCLASS(BlueprintType)
+class VIVOXINTEGRATION_API UVivoxNonPositionalChannelObject : public UVivoxChannelObject
+{
+	GENERATED_BODY()
+
+protected:
+
+	virtual ChannelId MakeChannelId(const FString& TokenIssuer, const FString& ChannelSessionId, const FString& Domain) const override;
+
+	virtual bool SupportsIdleSuspend() const override { return true; }
+
+public:
+
+	virtual EVivoxChannelType GetChannelType() const override { return EVivoxChannelType::NonPositional; }
+};
@@ -0,0 +1,113 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Objects/VivoxChannelObject.h"
+#include "WorldCollision.h"
+#include "VivoxPositionalChannelObject.generated.h"
+
+//Occlusion state of one participant mapped to a world actor
+struct FVivoxOcclusionEntry
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	//Resolved from the roster once the participant is in the channel
+	FString ParticipantId;
+
+	FTraceHandle PendingTrace;
+
+	//0 fully audible , 1 fully occluded
+	float TargetOcclusion = 0.0f;
+	float CurrentOcclusion = 0.0f;
+
+	//Last adjustment sent to the sdk
+	int32 AppliedVolumeAdjustment = 0;
+};
+
+/*
+  Positional (3d) voice channel , the only channel type carrying listener position state
+*/
+UCLASS(BlueprintType)
+class VIVOXINTEGRATION_API UVivoxPositionalChannelObject : public UVivoxChannelObject
+{
+	GENERATED_BODY()
+
+private:
+
+	//Set3DPosition calls counted over one second windows
+	int32 PositionUpdatesInWindow = 0;
+	double PositionUpdateWindowStart = 0.0;
+	float PositionUpdateRate = 0.0f;
+
+	//Occlusion keyed by account name , traced round robin with a per frame budget
+	TMap<FString, FVivoxOcclusionEntry> OcclusionEntries;
+	TArray<FString> OcclusionOrder;
+	int32 NextOcclusionIndex = 0;
+	TWeakObjectPtr<AActor> OcclusionListenerActor;
+
+	void TickOcclusion(float DeltaTime);
+	void CollectOcclusionResults(UWorld* World);
+	void StartOcclusionTraces(UWorld* World);
+	void ApplyOcclusionVolume(FVivoxOcclusionEntry& Entry);
+	bool ResolveParticipantId(const FString& AccountName, FVivoxOcclusionEntry& Entry) const;
+
+protected:
+
+	virtual ChannelId MakeChannelId(const FString& TokenIssuer, const FString& ChannelSessionId, const FString& Domain) const override;
+
+public:
+
+	virtual EVivoxChannelType GetChannelType() const override { return EVivoxChannelType::Positional; }
+
+	//Channel properties from the vivox settings , the server token minter builds its channel ids with them too
+	static Channel3DProperties MakeChannel3DProperties();
+
+	//Positional Channel Property 
+
+	CachedProperty<FVector> CachedPosition = CachedProperty<FVector>(FVector());
+	CachedProperty<FVector> CachedForwardVector = CachedProperty<FVector>(FVector());
+	CachedProperty<FVector> CachedUpVector = CachedProperty<FVector>(FVector());
+	bool Get3DValuesAreDirty() const;
+	void Clear3DValuesAreDirty();
+
+	virtual void UpdateVivox3dPosition(const FVector& position, const FVector& ForwardVector, const FVector& UpVector) override;
+
+	virtual void TickChannel(float DeltaTime) override;
+	virtual float GetPositionUpdateRate() const override { return PositionUpdateRate; }
+
+	//Occlusion
+
+	/*
+	  Maps a participant to the actor speaking for it so walls between the listener and the actor lower its volume
+	  @param AccountName Vivox account name of the participant
+	  @param Actor Actor of the participant in the world
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Positional|Occlusion", BlueprintCosmetic)
+	void RegisterParticipantActor(const FString& AccountName, AActor* Actor);
+
+	/*
+	  Removes the actor of a participant and restores its volume
+	  @param AccountName Vivox account name of the participant
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Positional|Occlusion", BlueprintCosmetic)
+	void UnregisterParticipantActor(const FString& AccountName);
+
+	/*
+	  Sets the actor of the local player , it is ignored by the occlusion traces
+	  @param Actor Actor of the local player
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Positional|Occlusion", BlueprintCosmetic)
+	void SetOcclusionListenerActor(AActor* Actor);
+
+	/*
+	  Gets the smoothed occlusion of a participant , 0 fully audible , 1 fully occluded
+	  @param AccountName Vivox account name of the participant
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Occlusion"), Category = "Vivox|VoiceChannel|Positional|Occlusion", BlueprintCosmetic)
+	float GetParticipantOcclusion(const FString& AccountName) const;
+
+	//UObject
+
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+};
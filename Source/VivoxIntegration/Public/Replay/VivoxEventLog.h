@@ -0,0 +1,117 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//
+
+//Everything the recorder captures, SDK callbacks first then subsystem and channel API calls
+enum class EVivoxRecordedEventType : uint8
+{
+	LoginCompleted = 0,
+	ConnectCompleted,
+	ParticipantAdded,
+	ParticipantUpdated,
+	ParticipantRemoved,
+	TextMessageReceived,
+	DeviceChanged,
+	ApiLogin,
+	ApiLogout,
+	ApiJoinChannel,
+	ApiLeaveChannel,
+	ApiSetAudioConnected,
+	ApiUpdate3dPosition,
+	ChannelStateChanged,
+	AudioStateChanged,
+	TextStateChanged,
+	Count
+};
+
+//Flags packed into FVivoxRecordedEvent::Value by ApiJoinChannel and ApiSetAudioConnected
+enum EVivoxRecordedAudioFlags : int32
+{
+	VivoxRecordedAudio_Listen = 1 << 0,
+	VivoxRecordedAudio_Transmit = 1 << 1,
+	VivoxRecordedAudio_Text = 1 << 2
+};
+
+struct VIVOXINTEGRATION_API FVivoxRecordedEvent
+{
+	//Seconds since the recording started
+	double Time = 0.0;
+	EVivoxRecordedEventType Type = EVivoxRecordedEventType::LoginCompleted;
+
+	//Channel events
+	EVivoxChannelType ChannelType = EVivoxChannelType::NonPositional;
+	FString ChannelSessionId;
+
+	//Participant events
+	FVivoxParticipantState Participant;
+
+	//Error code, audio flags or device direction (0 input , 1 output) depending on Type
+	int32 Value = 0;
+
+	//Player name, device name or text message sender
+	FString Name;
+
+	//Text message body
+	FString Text;
+
+	//ApiUpdate3dPosition
+	FVector Position = FVector::ZeroVector;
+	FVector ForwardVector = FVector::ZeroVector;
+	FVector UpVector = FVector::ZeroVector;
+
+	bool IsChannelEvent() const;
+};
+
+/*
+  Collects recorded events into a compact binary log , repeated ids and names are written once and referenced by index afterwards
+*/
+class VIVOXINTEGRATION_API FVivoxEventRecorder
+{
+public:
+	FVivoxEventRecorder();
+
+	//Stamps the event with the time since recording started and appends it
+	void Record(FVivoxRecordedEvent& Event);
+
+	bool SaveToFile(const FString& FilePath) const;
+
+	int32 Num() const { return NumEvents; }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	TArray<uint8> Buffer;
+	TMap<FString, int32> StringIndices;
+	TArray<FString> Strings;
+	double StartTime = 0.0;
+	double LastTime = 0.0;
+	int32 NumEvents = 0;
+};
+
+/*
+  Loads a log written by FVivoxEventRecorder and hands its events back in recorded order at real or scaled speed
+*/
+class VIVOXINTEGRATION_API FVivoxEventReplayer
+{
+public:
+	bool LoadFromFile(const FString& FilePath);
+
+	/*
+	  Advances the replay clock and dispatches every event that became due
+	  @param Speed Replay speed multiplier , 0 or less dispatches the whole log at once
+	*/
+	void Advance(float DeltaTime, float Speed, TFunctionRef<void(const FVivoxRecordedEvent&)> Dispatch);
+
+	bool IsFinished() const { return NextEvent >= Events.Num(); }
+	int32 Num() const { return Events.Num(); }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	TArray<FVivoxRecordedEvent> Events;
+	int32 NextEvent = 0;
+	double ElapsedTime = 0.0;
+};
@@ -4,16 +4,76 @@
 
 #include "CoreMinimal.h"
 #include "IAudioDevice.h"
+#include "VivoxCoreCommon.h"
+#include "HAL/LowLevelMemTracker.h"
 #include "VivoxResource.generated.h" 
 
 //Logcat
 DECLARE_LOG_CATEGORY_EXTERN(LogVivox, Log, All);
 //
 
+//Low level memory tracker tag for plugin and vivox sdk allocations
+LLM_DECLARE_TAG_API(Vivox, VIVOXINTEGRATION_API);
+
 DECLARE_DYNAMIC_DELEGATE(FOnSetAudioConnectedCompleted);
 DECLARE_DYNAMIC_DELEGATE_OneParam(FOnVivoxLoggedIn , bool,bLoginSuccessfull);
+DECLARE_DYNAMIC_DELEGATE(FOnVivoxLoggedOut);
 DECLARE_DYNAMIC_DELEGATE_OneParam(FOnVivoxChannelJoined, bool, bJoinSuccessfull);
 
+UENUM(BlueprintType)
+enum class EVivoxChannelBudgetAction : uint8
+{
+	//Audio dropped, channel stays joined through text
+	Demoted=0,
+	//Audio connected again after a demotion
+	Promoted=1,
+	//Channel left to stay within the joined channel budget
+	Evicted=2
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnVivoxConnectionStateChanged, class UVivoxChannelObject*, ChannelObject, ConnectionState, State);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnVivoxChannelBudgetAction, class UVivoxChannelObject*, ChannelObject, EVivoxChannelBudgetAction, Action);
+
+//Time spent in each stage of BeginVivoxBootstrap , in seconds
+USTRUCT(BlueprintType)
+struct FVivoxBootstrapTimings
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	float ModuleLoadSeconds = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float ClientInitializeSeconds = 0.0f;
+
+	//Time spent waiting for SetVivoxCredentials after the client was ready
+	UPROPERTY(BlueprintReadOnly)
+	float CredentialWaitSeconds = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float LoginSeconds = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float ChannelJoinSeconds = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float TotalSeconds = 0.0f;
+};
+
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnVivoxBootstrapCompleted, bool, bSuccess, const FVivoxBootstrapTimings&, Timings);
+
+UENUM(BlueprintType)
+enum class EVivoxBootstrapStage : uint8
+{
+	Idle=0,
+	LoadingModule=1,
+	InitializingClient=2,
+	WaitingForCredentials=3,
+	LoggingIn=4,
+	JoiningChannels=5
+};
+
 USTRUCT(BlueprintType)
 struct FVivoxCredentials
 {
@@ -47,6 +107,97 @@ enum class EVivoxDeviceVoiceStatus: uint8
 	UnMute=1
 };
 
+//Channel joined automatically at the end of BeginVivoxBootstrap
+USTRUCT(BlueprintType)
+struct FVivoxAutoJoinChannel
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	FString ChannelSessionId;
+
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	EVivoxChannelType ChannelType = EVivoxChannelType::NonPositional;
+
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	bool bConnectAudio = true;
+
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	bool bTransmitAudio = true;
+
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	bool bConnectText = false;
+};
+
+UENUM(BlueprintType)
+enum class EVivoxTokenAction : uint8
+{
+	Login=0,
+	Join=1
+};
+
+//Access token minted by the server token issuer , clients use it instead of signing with TokenKey
+USTRUCT(BlueprintType)
+struct FVivoxIssuedToken
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	EVivoxTokenAction Action = EVivoxTokenAction::Login;
+
+	//Account the token was minted for , the server picks it so login uses it instead of the player name
+	UPROPERTY(BlueprintReadOnly)
+	FString AccountName;
+
+	//Join tokens only
+	UPROPERTY(BlueprintReadOnly)
+	FString ChannelSessionId;
+
+	UPROPERTY(BlueprintReadOnly)
+	EVivoxChannelType ChannelType = EVivoxChannelType::NonPositional;
+
+	UPROPERTY(BlueprintReadOnly)
+	FString Token;
+
+	//Unix time in seconds
+	UPROPERTY(BlueprintReadOnly)
+	int64 ExpiresAt = 0;
+
+	bool IsExpired() const
+	{
+		return ExpiresAt <= FDateTime::UtcNow().ToUnixTimestamp();
+	}
+};
+
+//Channel entry of the desired channel set given to SetDesiredChannels
+USTRUCT(BlueprintType)
+struct FVivoxDesiredChannel
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FString ChannelSessionId;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EVivoxChannelType ChannelType = EVivoxChannelType::NonPositional;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bListenAudio = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bTransmitAudio = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bConnectText = false;
+};
+
+//Retry state of a desired channel whose join failed or whose connection was lost
+struct FVivoxRejoinBackoff
+{
+	int32 Attempts = 0;
+	double NextAttemptTime = 0.0;
+};
+
 //Audio Device data for input output hardware 
 USTRUCT(BlueprintType)
 struct FAudioDeviceData
@@ -71,6 +222,136 @@ struct FAudioDeviceData
 	}
 };
 
+//Roster entry for a participant of a voice channel, kept up to date from the channel session participant events
+USTRUCT(BlueprintType)
+struct FVivoxParticipantState
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	FString ParticipantId;
+
+	UPROPERTY(BlueprintReadOnly)
+	FString AccountName;
+
+	UPROPERTY(BlueprintReadOnly)
+	FString DisplayName;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bIsSelf = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bInAudio = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bSpeechDetected = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	double AudioEnergy = 0.0;
+
+	//Ids as names for the voice state snapshot , built once when the participant is added to the channel
+	FName SnapshotParticipantId;
+	FName SnapshotAccountName;
+};
+
+//Result of an echo channel voice self test , latencies are mouth to ear round trips in milliseconds
+USTRUCT(BlueprintType)
+struct FVivoxSelfTestResult
+{
+	GENERATED_USTRUCT_BODY()
+
+	//True if the test ran against the local loopback stand in instead of the vivox backend
+	UPROPERTY(BlueprintReadOnly)
+	bool bLoopback = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	float DurationSeconds = 0.0f;
+
+	//Speech onsets matched with their returned echo
+	UPROPERTY(BlueprintReadOnly)
+	int32 RoundTrips = 0;
+
+	//Speech onsets whose echo never came back in time
+	UPROPERTY(BlueprintReadOnly)
+	int32 MissedRoundTrips = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	float LatencyMinMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float LatencyP50Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float LatencyP90Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float LatencyP99Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float LatencyMaxMs = 0.0f;
+
+	//Input energy (0 to 1) averaged over the samples taken while speaking
+	UPROPERTY(BlueprintReadOnly)
+	float InputLevelAverage = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float InputLevelPeak = 0.0f;
+
+	//Share of speaking samples at or above the clipping energy (0 to 1)
+	UPROPERTY(BlueprintReadOnly)
+	float ClippedRatio = 0.0f;
+};
+
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnVivoxSelfTestCompleted, bool, bSuccess, const FVivoxSelfTestResult&, Result);
+
+//Text message received in a channel
+USTRUCT(BlueprintType)
+struct FVivoxTextMessage
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	FString SenderAccountName;
+
+	UPROPERTY(BlueprintReadOnly)
+	FString SenderDisplayName;
+
+	UPROPERTY(BlueprintReadOnly)
+	FString Message;
+
+	UPROPERTY(BlueprintReadOnly)
+	FDateTime ReceivedTime;
+};
+
+//Physical channels backing one sharded channel
+USTRUCT()
+struct FVivoxShardedChannel
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	int32 ShardCount = 1;
+
+	UPROPERTY()
+	bool bDesignatedSpeaker = false;
+
+	UPROPERTY()
+	bool bTransmitAudio = true;
+
+	//Shard the player id hashes to and how many full shards were skipped from it
+	UPROPERTY()
+	int32 HomeShard = 0;
+
+	UPROPERTY()
+	int32 ShardOffset = 0;
+
+	//Session ids of the shards joined by the player
+	UPROPERTY()
+	TArray<FString> JoinedShards;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVivoxTextMessagesReceived, const TArray<FVivoxTextMessage>&, Messages);
+
 // Class for AudioDevice Abstract class 
 class UVivoxAudioDevice : public IAudioDevice
 {
@@ -0,0 +1,89 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Fixed capacity buffer that overwrites its oldest item once full, memory never grows past the capacity
+template<typename T>
+class TVivoxRingBuffer
+{
+public:
+	explicit TVivoxRingBuffer(int32 InCapacity = 0)
+	{
+		SetCapacity(InCapacity);
+	}
+
+	//Changes the capacity, this clears the buffer
+	void SetCapacity(int32 InCapacity)
+	{
+		Capacity = FMath::Max(InCapacity, 0);
+		Items.Empty(Capacity);
+		NextIndex = 0;
+	}
+
+	int32 GetCapacity() const
+	{
+		return Capacity;
+	}
+
+	int32 Num() const
+	{
+		return Items.Num();
+	}
+
+	void Add(const T& Item)
+	{
+		if (Capacity == 0)
+			return;
+
+		if (Items.Num() < Capacity)
+		{
+			Items.Add(Item);
+		}
+		else
+		{
+			Items[NextIndex] = Item;
+		}
+		NextIndex = (NextIndex + 1) % Capacity;
+	}
+
+	void Reset()
+	{
+		Items.Reset();
+		NextIndex = 0;
+	}
+
+	//Visits the items from oldest to newest
+	template<typename FunctionType>
+	void ForEach(FunctionType&& Function) const
+	{
+		const int32 Oldest = Items.Num() < Capacity ? 0 : NextIndex;
+		for (int32 Offset = 0; Offset < Items.Num(); ++Offset)
+		{
+			Function(Items[(Oldest + Offset) % Items.Num()]);
+		}
+	}
+
+	//Copies the items from oldest to newest
+	TArray<T> ToArray() const
+	{
+		TArray<T> Result;
+		Result.Reserve(Items.Num());
+		ForEach([&Result](const T& Item)
+			{
+				Result.Add(Item);
+			});
+		return Result;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Items.GetAllocatedSize();
+	}
+
+private:
+	TArray<T> Items;
+	int32 Capacity = 0;
+	int32 NextIndex = 0;
+};
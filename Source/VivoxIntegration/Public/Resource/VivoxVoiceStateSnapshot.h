@@ -0,0 +1,121 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//
+#include <atomic>
+
+//Participant of a channel in a voice state snapshot , ids are names so reading and comparing them never allocates
+struct FVivoxParticipantSnapshot
+{
+	FName ParticipantId;
+	FName AccountName;
+	bool bIsSelf = false;
+	bool bInAudio = false;
+	bool bSpeechDetected = false;
+	float AudioEnergy = 0.0f;
+};
+
+//Channel in a voice state snapshot , its participants are Participants[FirstParticipant , FirstParticipant + NumParticipants) of the snapshot
+struct FVivoxChannelSnapshot
+{
+	FName ChannelSessionId;
+	EVivoxChannelType ChannelType = EVivoxChannelType::NonPositional;
+	ConnectionState ChannelState = ConnectionState::Disconnected;
+	ConnectionState AudioState = ConnectionState::Disconnected;
+	ConnectionState TextState = ConnectionState::Disconnected;
+	bool bAudioIdleSuspended = false;
+	bool bBudgetDemoted = false;
+	int32 FirstParticipant = 0;
+	int32 NumParticipants = 0;
+};
+
+//Voice state of one frame , immutable while it is published
+struct VIVOXINTEGRATION_API FVivoxVoiceStateSnapshot
+{
+	//GFrameCounter and FPlatformTime::Seconds when the snapshot was filled
+	uint64 FrameNumber = 0;
+	double Time = 0.0;
+
+	TArray<FVivoxChannelSnapshot> Channels;
+	TArray<FVivoxParticipantSnapshot> Participants;
+
+	TConstArrayView<FVivoxParticipantSnapshot> GetParticipants(const FVivoxChannelSnapshot& Channel) const
+	{
+		return TConstArrayView<FVivoxParticipantSnapshot>(Participants.GetData() + Channel.FirstParticipant, Channel.NumParticipants);
+	}
+
+	const FVivoxChannelSnapshot* FindChannel(FName ChannelSessionId) const;
+
+	//True if the account speaks in any channel , AudioEnergy is the highest energy of the account
+	bool IsSpeaking(FName AccountName, float& AudioEnergy) const;
+
+	//Empties the arrays keeping their memory so filling the next frame does not allocate
+	void Reset();
+
+	SIZE_T GetAllocatedSize() const { return Channels.GetAllocatedSize() + Participants.GetAllocatedSize(); }
+};
+
+class FVivoxVoiceStateBuffer;
+
+/*
+  Pins the published snapshot while it is in scope , the snapshot is not written until the scope ends
+  Keep it short lived (one task or one frame) , a snapshot pinned for longer delays the next publishes
+*/
+class VIVOXINTEGRATION_API FVivoxVoiceStateReadScope
+{
+public:
+	FVivoxVoiceStateReadScope(FVivoxVoiceStateReadScope&& Other);
+	FVivoxVoiceStateReadScope(const FVivoxVoiceStateReadScope&) = delete;
+	FVivoxVoiceStateReadScope& operator=(const FVivoxVoiceStateReadScope&) = delete;
+	FVivoxVoiceStateReadScope& operator=(FVivoxVoiceStateReadScope&&) = delete;
+	~FVivoxVoiceStateReadScope();
+
+	const FVivoxVoiceStateSnapshot& Get() const { return *Snapshot; }
+	const FVivoxVoiceStateSnapshot* operator->() const { return Snapshot; }
+	const FVivoxVoiceStateSnapshot& operator*() const { return *Snapshot; }
+
+private:
+	friend class FVivoxVoiceStateBuffer;
+	FVivoxVoiceStateReadScope(const FVivoxVoiceStateBuffer* InBuffer, int32 InSlot);
+
+	const FVivoxVoiceStateBuffer* Buffer = nullptr;
+	const FVivoxVoiceStateSnapshot* Snapshot = nullptr;
+	int32 Slot = INDEX_NONE;
+};
+
+/*
+  Double buffered voice state , the game thread fills the back snapshot and publishes it by swapping the front index
+  Any thread can read the front snapshot with Read , reading takes no lock , does not allocate and never calls the vivox sdk
+  A publish is skipped while a reader still pins the back snapshot (the front of the previous frame) , readers then keep seeing the last published frame
+*/
+class VIVOXINTEGRATION_API FVivoxVoiceStateBuffer
+{
+public:
+	FVivoxVoiceStateBuffer() = default;
+	FVivoxVoiceStateBuffer(const FVivoxVoiceStateBuffer&) = delete;
+	FVivoxVoiceStateBuffer& operator=(const FVivoxVoiceStateBuffer&) = delete;
+
+	//Game thread only , Fill gets the reset back snapshot , returns false if the publish was skipped
+	bool TryPublish(TFunctionRef<void(FVivoxVoiceStateSnapshot&)> Fill);
+
+	//Any thread , pins the last published snapshot
+	FVivoxVoiceStateReadScope Read() const;
+
+	//Publishes skipped because the back snapshot was pinned
+	uint32 GetNumSkippedPublishes() const { return NumSkippedPublishes; }
+
+	SIZE_T GetAllocatedSize() const { return Snapshots[0].GetAllocatedSize() + Snapshots[1].GetAllocatedSize(); }
+
+private:
+	friend class FVivoxVoiceStateReadScope;
+	void Unpin(int32 Slot) const;
+
+	FVivoxVoiceStateSnapshot Snapshots[2];
+	std::atomic<int32> FrontSlot{ 0 };
+	mutable std::atomic<int32> ReaderCounts[2] = { {0}, {0} };
+	uint32 NumSkippedPublishes = 0;
+};
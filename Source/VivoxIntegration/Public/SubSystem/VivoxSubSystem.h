@@ -4,12 +4,26 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
 //Objects
 #include "Objects/VivoxChannelObject.h"
+#include "Objects/VivoxEchoChannelObject.h"
 //
 //Resource
 #include "Resource/VivoxResource.h"
 //
+//Replay
+#include "Replay/VivoxEventLog.h"
+//
+//Debug
+#include "Debug/VivoxDebugHud.h"
+//
+//Metrics
+#include "Metrics/VivoxMetricsWriter.h"
+//
+//Resource
+#include "Resource/VivoxVoiceStateSnapshot.h"
+//
 //Vivox
 #include "IClient.h"
 #include "VivoxCore.h"
@@ -19,7 +33,7 @@
 
 
 UCLASS()
-class VIVOXINTEGRATION_API UVivoxSubSystem : public UGameInstanceSubsystem
+class VIVOXINTEGRATION_API UVivoxSubSystem : public UGameInstanceSubsystem, public FTickableGameObject
 {
 	GENERATED_BODY()
 	
@@ -28,25 +42,238 @@ private:
 	
 	FVivoxCredentials Credentials;
 
+	//Set in Initialize when voice chat can never be used in this game instance
+	bool bVivoxDisabled = false;
+	static bool ShouldDisableVivox(const UGameInstance* GameInstance);
+
+	//Runs Function on every registered channel object
+	void ForEachChannel(TFunctionRef<void(UVivoxChannelObject*)> Function) const;
+
+	//Channel budget
+	bool bChannelBudgetDirty = false;
+	void EnforceChannelBudget();
+
+	//Client setup steps used by InitializeVivox and the bootstrap
+	bool bVivoxClientInitialized = false;
+	void LoadVivoxModule();
+	void InitializeVivoxClient();
+	bool HasValidCredentials() const;
+
+	//Server issued tokens , join tokens keyed by MakeChannelKey
+	FVivoxIssuedToken ExternalLoginToken;
+	TMap<FString, FVivoxIssuedToken> ExternalJoinTokens;
+
+	//True if tokens can be signed locally or come from the server
+	bool HasTokenSource() const { return UsesExternalTokens() || Credentials.TokenKey != ""; }
+
+	//Bootstrap
+	EVivoxBootstrapStage BootstrapStage = EVivoxBootstrapStage::Idle;
+	FString BootstrapPlayerName;
+	FOnVivoxBootstrapCompleted OnBootstrapCompleted;
+	FVivoxBootstrapTimings BootstrapTimings;
+	double BootstrapStartTime = 0.0;
+	double BootstrapStageStartTime = 0.0;
+	int32 BootstrapPendingJoins = 0;
+	int32 BootstrapFailedJoins = 0;
+
+	void TickBootstrap();
+	void TryStartBootstrapLogin();
+	float AdvanceBootstrapStage(EVivoxBootstrapStage NextStage);
+	void FinishBootstrap(bool bSuccess);
+
+	UFUNCTION()
+	void HandleBootstrapLoggedIn(bool bLoginSuccessfull);
+
+	UFUNCTION()
+	void HandleBootstrapChannelJoined(bool bJoinSuccessfull);
+
+	//Desired channel reconciler
+	TMap<FString, FVivoxDesiredChannel> DesiredChannels;
+	TSet<FString> BudgetEvictedChannels;
+	TMap<FString, FVivoxRejoinBackoff> DesiredChannelBackoff;
+	bool bDesiredChannelsActive = false;
+	bool bDesiredChannelsDirty = false;
+
+	static FString MakeChannelKey(EVivoxChannelType ChannelType, const FString& ChannelSessionId);
+	void ReconcileDesiredChannels();
+
+	UFUNCTION()
+	void HandleReconcileChannelJoined(bool bJoinSuccessfull);
+
+	//Sharded channels keyed by logical channel id
+	TMap<FString, FVivoxShardedChannel> ShardedChannels;
+	TSet<FString> ShardSessionIds;
+	double NextShardCapacityCheckTime = 0.0;
+
+	void JoinShard(const FString& ShardId, bool bDesignatedSpeaker, bool bTransmitAudio, FOnVivoxChannelJoined OnChannelJoined);
+	void LeaveShards(const TArray<FString>& ShardIds);
+	//Moves the players ranked past MaxParticipantsPerShard in a full shard to the next shard
+	void EnforceShardCapacity();
+	//Drops shards released from outside (channel budget) from the sharded channel bookkeeping
+	void PruneReleasedShard(const FString& ShardId);
+
+	//Transmission before a designated speaker took it over , restored once no speaker shard is left
+	bool bShardTransmissionActive = false;
+	TransmissionMode SavedTransmissionMode = TransmissionMode::None;
+	ChannelId SavedTransmissionChannel;
+
+	void RefreshShardTransmission();
+
+	//Voice self test , the end time is set once the echo channel is connected
+	TWeakObjectPtr<UVivoxEchoChannelObject> SelfTestChannel;
+	//Loopback echo channel , outered to the subsystem and ticked on its own like the replayed channels so it never reaches the live registries
+	UPROPERTY(Transient)
+	UVivoxEchoChannelObject* LoopbackSelfTestChannel = nullptr;
+	FOnVivoxSelfTestCompleted OnSelfTestCompleted;
+	bool bSelfTestRunning = false;
+	float SelfTestDuration = 0.0f;
+	double SelfTestEndTime = 0.0;
+
+	//Transmission before the echo channel took it over , restored when the test ends
+	bool bSelfTestTransmissionSaved = false;
+	TransmissionMode SelfTestSavedTransmissionMode = TransmissionMode::None;
+	ChannelId SelfTestSavedTransmissionChannel;
+
+	void FinishVoiceSelfTest(bool bSuccess);
+
+	UFUNCTION()
+	void HandleSelfTestChannelJoined(bool bJoinSuccessfull);
+
+	//Login in flight , failed when logging out before it completes
+	TSharedPtr<TVivoxAsyncOperation<bool>> PendingLoginOperation;
+
+	//Async operations completed at the start of the next tick (logout , joins failed by a teardown)
+	TArray<TPair<TVivoxAsyncOperationRef<bool>, bool>> DeferredCompletions;
+
+	//Releases every channel in one pass , the registries are emptied at once and a single garbage collection is requested for the batch
+	int32 ShutdownAllChannels();
+
+	//Leaves Channels without a garbage collection per channel , one collection is requested for the batch
+	int32 ReleaseChannels(TConstArrayView<UVivoxChannelObject*> Channels);
+
+	//Logout started by LogoutAsync , channels are released over several frames before the session logs out
+	UPROPERTY(Transient)
+	TArray<UVivoxChannelObject*> PendingLogoutChannels;
+	ILoginSession* PendingLogoutSession = nullptr;
+	TArray<TVivoxAsyncOperationRef<bool>> PendingLogoutOperations;
+
+	//Leaves waiting for their Disconnected state , see TrackLeaveOperation
+	TArray<TVivoxAsyncOperationRef<bool>> PendingLeaveOperations;
+	void CompletePendingLeaves();
+
+	//Detaches the login session and the channels from the subsystem , the sdk teardown is left to FinishLogout
+	void BeginLogoutTeardown();
+	void TickPendingLogout();
+	void FinishLogout();
+	bool IsLogoutPending() const { return PendingLogoutSession != nullptr; }
+
+	//Record and replay
+	TUniquePtr<FVivoxEventRecorder> EventRecorder;
+	TUniquePtr<FVivoxEventReplayer> EventReplayer;
+	float EventReplaySpeed = 1.0f;
+	FDelegateHandle InputDeviceChangedHandle;
+	FDelegateHandle OutputDeviceChangedHandle;
+
+	//Channels created by the replay keyed by MakeChannelKey , outered to the subsystem so they never reach the live registries , budget , reconciler or metrics
+	UPROPERTY(Transient)
+	TMap<FString, UVivoxChannelObject*> ReplayChannels;
+
+	//Login and device state of the replayed session , the live session state is never touched by a replay
+	bool bReplayLoggedIn = false;
+	double ReplayLoginStartTime = 0.0;
+	int32 ReplayDeviceFailovers = 0;
+
+	void DispatchReplayedEvent(const FVivoxRecordedEvent& Event);
+	void ReleaseReplayChannels();
+
+	//Debug hud , only exists while shown
+	TUniquePtr<FVivoxDebugHud> DebugHud;
+
+	//Metrics , the writer only exists while the metrics log is enabled
+	TUniquePtr<FVivoxMetricsWriter> MetricsWriter;
+	double NextMetricsSampleTime = 0.0;
+	double LoginStartTime = 0.0;
+	//True from login until the session summary is written
+	bool bSessionSummaryPending = false;
+	int32 SessionReconnects = 0;
+	int32 SessionDeviceFailovers = 0;
+	int32 SessionPeakParticipants = 0;
+	float SessionPeakPositionRate = 0.0f;
+
+	//One file per process and play in editor instance , game instances never share a writer
+	FString GetMetricsFileName() const;
+	void StartMetrics();
+	void StopMetrics();
+	void SampleChannelMetrics();
+	void RecordSessionSummary();
+	void RecordDeviceFailover(const TCHAR* Direction, const FString& DeviceName, bool bReplayed);
+	void OnEffectiveInputDeviceChanged(const IAudioDevice& Device);
+	void OnEffectiveOutputDeviceChanged(const IAudioDevice& Device);
+
+	//Shared by the sdk callbacks and the replay , a replayed event only updates the replay state and writes no metrics
+	void HandleEffectiveDeviceChanged(bool bOutput, const FString& DeviceName, bool bReplayed);
+	void HandleLoginCompleted(VivoxCoreError Error, double LoginSeconds, bool bReplayed);
+
+	//Voice state snapshot , shared so worker code can keep the buffer alive past the subsystem
+	TSharedRef<FVivoxVoiceStateBuffer, ESPMode::ThreadSafe> VoiceStateBuffer = MakeShared<FVivoxVoiceStateBuffer, ESPMode::ThreadSafe>();
+
+	void PublishVoiceState();
+
 public:
 
 	//VivoxBasePropertySet
 
-	IClient* VivoxVoiceClient;
+	IClient* VivoxVoiceClient = nullptr;
 	AccountId LoggedInUserId;
 
 	//VivoxLoginPropertySet
 
+	//One login per game instance , split screen local players share it
 	bool bIsLoggedIn = false;
 	ILoginSession* LoginSession = nullptr;
+	//Player name passed to the last login , LoggedInUserId gets a new uuid on every login
+	FString LoggedInPlayerName;
 
 	//Channel Objects
 
+	UPROPERTY(Transient)
 	TMap<FString, UVivoxChannelObject*> EchoChannels;
+	UPROPERTY(Transient)
 	TMap<FString, UVivoxChannelObject*> NonPostionalChannels;
+	UPROPERTY(Transient)
 	TMap<FString, UVivoxChannelObject*> PositionalChannels;
 
+	//Registry holding channels of ChannelType
+	TMap<FString, UVivoxChannelObject*>* GetChannelRegistry(EVivoxChannelType ChannelType);
+
+	//Channel object class created for ChannelType
+	static TSubclassOf<UVivoxChannelObject> GetChannelClass(EVivoxChannelType ChannelType);
+
+	//Called when the channel budget demotes, promotes or evicts a channel
+	UPROPERTY(BlueprintAssignable, Category = "Vivox|VoiceChannel|Budget")
+	FOnVivoxChannelBudgetAction OnChannelBudgetAction;
+
 public:
+
+	//USubsystem
+
+	//Created on every game instance , on dedicated servers , headless clients and builds without the vivox backend it stays disabled and the api does nothing
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/*
+	  False on dedicated servers , headless clients , with -NoVivox and in builds without the vivox backend , every vivox call is then a no-op
+	*/
+	UFUNCTION(BlueprintPure, Category = "Vivox", BlueprintCosmetic)
+	bool IsVivoxAvailable() const { return !bVivoxDisabled; }
+
+	//FTickableGameObject
+
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return !bVivoxDisabled; }
+	virtual bool IsTickableWhenPaused() const override { return true; }
+	virtual TStatId GetStatId() const override;
 	
 	//Credentials
 
@@ -69,20 +296,53 @@ public:
 		return Credentials;
 	}
 
+	/*
+	  Gives the subsystem login and join tokens minted by the server , used instead of TokenKey while bUseServerIssuedTokens is on (UVivoxChannelAssignmentComponent calls it)
+	  @param Tokens Issued tokens , replacing earlier tokens for the same login or channel
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Credentials", BlueprintCosmetic)
+	void SetExternalTokens(const TArray<FVivoxIssuedToken>& Tokens);
+
+	static bool UsesExternalTokens();
+
+	//Unexpired server issued join token of the channel or null
+	const FVivoxIssuedToken* FindExternalJoinToken(EVivoxChannelType ChannelType, const FString& ChannelSessionId) const;
+
 	//Base Vivox Functions
 
 	/*
-	  Initializes the vivox 
+	  Initializes the vivox , the voice client is shared by every game instance and only the first one initializes the sdk
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Vivox", BlueprintCosmetic)
 	void InitializeVivox();
 
 	/*
-	  UnInitializes the vivox
+	  UnInitializes the vivox , logs this game instance out and uninitializes the sdk once no other game instance uses it
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Vivox", BlueprintCosmetic)
 	void UnInitializeVivox();
 
+	/*
+	  Initializes vivox, logs in and joins the AutoJoinChannels from vivox settings, module load and client initialize get a frame each so it can run behind the loading screen.
+	  Credentials can be fetched while the client initializes , login starts in the frame both are ready (the sdk needs the initialized client to generate the login token)
+	  @param PlayerName Player name to login with
+	  @param OnCompleted Callback event with the time spent in every stage
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox", BlueprintCosmetic)
+	void BeginVivoxBootstrap(FString PlayerName, FOnVivoxBootstrapCompleted OnCompleted);
+
+	/*
+	  Stops a running bootstrap , stages already done are kept
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox", BlueprintCosmetic)
+	void CancelVivoxBootstrap();
+
+	/*
+	  Gets the current stage of the bootstrap
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Stage"), Category = "Vivox", BlueprintCosmetic)
+	EVivoxBootstrapStage GetVivoxBootstrapStage() const { return BootstrapStage; }
+
 	//Vivox Login Functions
 	
 	/*
@@ -93,11 +353,39 @@ public:
 	void Login(FString PlayerName,FOnVivoxLoggedIn OnLogin);
 
 	/*
-	  Logout from the vivox server
+	  Logout from the vivox server , every channel is left at once and the desired channels are cleared
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Vivox", BlueprintCosmetic)
 	void Logout();
 
+	/*
+	  Logout from the vivox server , the channels are left over several frames (LogoutChannelsPerFrame) and OnLoggedOut is called once the session is logged out so a level transition can wait for the teardown without blocking on it
+	  @param OnLoggedOut Callback event once logged out
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox", BlueprintCosmetic)
+	void BeginLogout(FOnVivoxLoggedOut OnLoggedOut);
+
+	//Native async api , the Blueprint functions are built on it
+	//Futures complete on the game thread , chain them with Then and combine them with VivoxAsync::WhenAll
+
+	//Completes with the login result , cancelling a pending login logs out
+	TFuture<bool> LoginAsync(const FString& PlayerName, const FVivoxCancellationToken& CancellationToken = FVivoxCancellationToken());
+
+	//Logs out and leaves every channel spread over several frames , completes once the session is logged out
+	TFuture<bool> LogoutAsync();
+
+	//Completes with the joined channel object or null if the join failed , cancelling a pending join leaves the channel
+	TFuture<UVivoxChannelObject*> JoinChannelAsync(const FString& ChannelSessionId, EVivoxChannelType ChannelType, bool bConnectAudio = true, bool bTransmitAudio = true, bool bConnectText = false, const FVivoxCancellationToken& CancellationToken = FVivoxCancellationToken());
+
+	//Completes with true once the sdk reports the channel disconnected , false if the channel was not joined
+	TFuture<bool> LeaveChannelAsync(const FString& ChannelSessionId, EVivoxChannelType ChannelType);
+
+	//Leave waiting for the Disconnected state of its channel session , completed by the logout if the session goes away first
+	void TrackLeaveOperation(const TVivoxAsyncOperationRef<bool>& Operation) { PendingLeaveOperations.Add(Operation); }
+
+	//Completes Operation at the start of the next tick
+	void CompleteNextTick(const TVivoxAsyncOperationRef<bool>& Operation, bool bResult);
+
 	//Vivox Channel Functions
 	
 	/*
@@ -108,9 +396,10 @@ public:
 	  @param ChannelObject Channel object created using Channel Id
 	  @param bConnectAudio if true Player can listen from the channel , if false Player cannot listen from the channel
 	  @param bTransmitAudio if true Player can speak in the channel , if false Player cannot speak in the channel it can only hear from it if ConnectAudio is true
+	  @param bConnectText if true Player can send and receive text messages in the channel
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel", BlueprintCosmetic)
-	void CreateAndJoinVoiceChannel(FString ChannelSessionId, EVivoxChannelType ChannelType, FOnVivoxChannelJoined OnChannelJoined, UVivoxChannelObject*& ChannelObject, bool bConnectAudio = true, bool bTransmitAudio = true);
+	void CreateAndJoinVoiceChannel(FString ChannelSessionId, EVivoxChannelType ChannelType, FOnVivoxChannelJoined OnChannelJoined, UVivoxChannelObject*& ChannelObject, bool bConnectAudio = true, bool bTransmitAudio = true, bool bConnectText = false);
 
 	/*
 	  Gets all voice channel of specific type
@@ -127,6 +416,184 @@ public:
 	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "VoiceChannel"),Category = "Vivox|VoiceChannel", BlueprintCosmetic)
 	UVivoxChannelObject* GetChannelOfType(EVivoxChannelType ChannelType ,FString ChannelSessionId) const;
 
+	/*
+	  Declares the full set of channels the player should be in , the subsystem joins, leaves and changes audio only where the live channels differ.
+	  Calling it again before earlier joins complete is fine , only the last set is applied and channels already connecting are not connected again
+	  @param Channels Every channel the player should be in, channels not in the list are left
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel", BlueprintCosmetic)
+	void SetDesiredChannels(const TArray<FVivoxDesiredChannel>& Channels);
+
+	/*
+	  Stops managing channels from the desired set, channels stay as they are
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel", BlueprintCosmetic)
+	void ClearDesiredChannels();
+
+	//Sharded Channels
+
+	/*
+	  Joins a large non positional channel split into shards , the player joins the one shard its player id hashes to so the per client load stays flat as the room grows.
+	  A shard holding more than MaxParticipantsPerShard moves its last players (by account name) to the next shard.
+	  Designated speakers (casters , leaders) join every shard and transmit into the shards only , the previous transmission is restored once they leave. Joining again with a new size only moves the players whose shard changed.
+	  Fails with server issued tokens , the server only mints join tokens for the channels it assigned and shards are picked on the client
+	  @param LogicalChannelId Channel Id shared by all shards
+	  @param PlayerId Id of the player that stays the same across logins (platform or backend user id) , the login player name is used if empty
+	  @param ExpectedParticipants Expected room size , every client has to pass the same value to agree on the shard count
+	  @param bDesignatedSpeaker if true joins and transmits into every shard
+	  @param OnChannelJoined Callback event , called once per joined shard
+	  @param bTransmitAudio if true Player can speak in its shard , designated speakers always transmit
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Sharding", BlueprintCosmetic)
+	void JoinShardedChannel(FString LogicalChannelId, FString PlayerId, int32 ExpectedParticipants, bool bDesignatedSpeaker, FOnVivoxChannelJoined OnChannelJoined, bool bTransmitAudio = true);
+
+	/*
+	  Leaves every shard of a sharded channel , restores the transmission a designated speaker replaced
+	  @param LogicalChannelId Channel Id shared by all shards
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|VoiceChannel|Sharding", BlueprintCosmetic)
+	void LeaveShardedChannel(FString LogicalChannelId);
+
+	/*
+	  Gets the channel objects of the shards the player is in
+	  @param LogicalChannelId Channel Id shared by all shards
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "VoiceChannels"), Category = "Vivox|VoiceChannel|Sharding", BlueprintCosmetic)
+	TArray<UVivoxChannelObject*> GetShardedChannelObjects(FString LogicalChannelId) const;
+
+	//Number of shards for a room of ExpectedParticipants with the configured MaxParticipantsPerShard
+	static int32 GetShardCount(int32 ExpectedParticipants);
+
+	//Session id of one shard
+	static FString MakeShardSessionId(const FString& LogicalChannelId, int32 ShardIndex);
+
+	//Record and replay
+
+	/*
+	  Starts recording every vivox callback and subsystem call into a binary event log
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Debug", BlueprintCosmetic)
+	void StartEventRecording();
+
+	/*
+	  Stops recording and writes the event log
+	  @param FilePath File to write , empty writes to Saved/Vivox with a timestamped name
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Debug", meta = (ReturnDisplayName = "Success"), BlueprintCosmetic)
+	bool StopEventRecording(const FString& FilePath);
+
+	/*
+	  Replays an event log into offline channel objects without touching the vivox sdk , to profile event handling
+	  @param FilePath Event log written by StopEventRecording
+	  @param Speed Replay speed multiplier , 0 replays the whole log in one frame
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Debug", meta = (ReturnDisplayName = "Success"), BlueprintCosmetic)
+	bool StartEventReplay(const FString& FilePath, float Speed = 1.0f);
+
+	/*
+	  Stops a running replay and releases the replayed channels
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Debug", BlueprintCosmetic)
+	void StopEventReplay();
+
+	bool IsRecordingEvents() const { return EventRecorder.IsValid(); }
+	bool IsReplayingEvents() const { return EventReplayer.IsValid(); }
+
+	//Offline channels fed by the running or last replay
+	const TMap<FString, UVivoxChannelObject*>& GetReplayChannels() const { return ReplayChannels; }
+	bool IsReplayLoggedIn() const { return bReplayLoggedIn; }
+	int32 GetReplayDeviceFailovers() const { return ReplayDeviceFailovers; }
+	void RecordEvent(FVivoxRecordedEvent& Event)
+	{
+		if (EventRecorder.IsValid())
+		{
+			EventRecorder->Record(Event);
+		}
+	}
+
+	//Debug hud
+
+	/*
+	  Shows or hides the on screen voice debug overlay (channels , connection states , participants , speaking energy)
+	  @param bEnabled True to show the overlay
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Debug", BlueprintCosmetic)
+	void SetDebugHudEnabled(bool bEnabled);
+
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Enabled"), Category = "Vivox|Debug", BlueprintCosmetic)
+	bool IsDebugHudEnabled() const { return DebugHud.IsValid(); }
+
+	//Voice self test
+
+	/*
+	  Joins a private echo channel and measures mouth to ear round trip latency , input level and clipping while the player talks , for voice settings menus
+	  Transmission moves to the echo channel while the test runs and is restored afterwards , say short words with pauses so the echo picked up by the microphone is heard as its own burst
+	  @param DurationSeconds Time measured after the echo channel connected
+	  @param bUseLoopback True to run against the local loopback stand in (no login or vivox backend needed) , always used when the vivox client is not available
+	  @param OnCompleted Called with the results when the test ends or fails
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|SelfTest", meta = (ReturnDisplayName = "Started"), BlueprintCosmetic)
+	bool StartVoiceSelfTest(float DurationSeconds, bool bUseLoopback, FOnVivoxSelfTestCompleted OnCompleted);
+
+	/*
+	  Ends a running self test early , OnCompleted is called with the results measured so far
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|SelfTest", BlueprintCosmetic)
+	void StopVoiceSelfTest();
+
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Running"), Category = "Vivox|SelfTest", BlueprintCosmetic)
+	bool IsVoiceSelfTestRunning() const { return bSelfTestRunning; }
+
+	/*
+	  Results measured so far by the running self test , to drive input meters while it runs
+	*/
+	UFUNCTION(BlueprintPure, meta = (ReturnDisplayName = "Result"), Category = "Vivox|SelfTest", BlueprintCosmetic)
+	FVivoxSelfTestResult GetVoiceSelfTestProgress() const;
+
+	//Metrics
+
+	bool IsRecordingMetrics() const { return MetricsWriter.IsValid(); }
+	void RecordMetric(const TCHAR* Event, TFunctionRef<void(FVivoxMetricsJsonWriter&)> Fill)
+	{
+		if (MetricsWriter.IsValid())
+		{
+			MetricsWriter->Record(Event, Fill);
+		}
+	}
+
+	//Called by the channel objects
+	void ReportChannelJoined(const UVivoxChannelObject* ChannelObject, bool bSuccess, float Seconds);
+	void ReportChannelLeft(const UVivoxChannelObject* ChannelObject, double ConnectedSeconds, int32 PeakParticipants);
+	void ReportChannelReconnecting(const UVivoxChannelObject* ChannelObject);
+
+	//Voice state snapshot
+
+	/*
+	  Pins the voice state published at the end of the last vivox tick (channels , connection states , participants , speaking and energy)
+	  Safe on any thread , takes no lock , does not allocate and never calls the vivox sdk , keep the returned scope short lived
+	  Stays empty unless bPublishVoiceStateSnapshot is enabled in the vivox settings
+	*/
+	FVivoxVoiceStateReadScope ReadVoiceState() const { return VoiceStateBuffer->Read(); }
+
+	//Buffer of the voice state for code that reads it after the subsystem may be gone (audio render , tasks)
+	TSharedRef<const FVivoxVoiceStateBuffer, ESPMode::ThreadSafe> GetVoiceStateBuffer() const { return VoiceStateBuffer; }
+
+	//Memory
+
+	//Subsystem containers , channel objects are added in EstimatedTotal mode only
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+	//Logs the memory used by the subsystem and by every channel
+	void DumpMemoryUsage();
+
+	//Channel Budget
+
+	//Requests the channel budget to be checked again on the next tick
+	void MarkChannelBudgetDirty() { bChannelBudgetDirty = true; }
+
+	//Requests the desired channel set to be reconciled again on the next tick , called when a channel drops
+	void MarkDesiredChannelsDirty() { bDesiredChannelsDirty = bDesiredChannelsActive; }
+
 	//Vivox Device functions
 
 	/*
@@ -243,6 +710,26 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Vivox|Device", meta = (Keywords = "Output Device", ReturnDisplayName = "AudioDevices"), BlueprintCosmetic)
 	TMap<FString, FAudioDeviceData> GetAvailableOutputDevices();
 
+	//Voice Profile Functions
+
+	/*
+	  Saves the current active devices, volumes and mute states as the voice profile applied on next InitializeVivox
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Device|Profile", BlueprintCosmetic)
+	void SaveVoiceProfile();
+
+	/*
+	  Applies the saved voice profile with a single device refresh per direction , saved devices that are no longer connected are skipped
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Device|Profile", BlueprintCosmetic)
+	void ApplyVoiceProfile();
+
+	/*
+	  Removes the saved voice profile
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vivox|Device|Profile", BlueprintCosmetic)
+	void ClearVoiceProfile();
+
 	//Transmission Mode Functions
 
 	/*
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+class IClient;
+
 class FVivoxIntegrationModule : public IModuleInterface
 {
 public:
@@ -13,7 +15,31 @@ public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
+	static FVivoxIntegrationModule& Get()
+	{
+		return FModuleManager::LoadModuleChecked<FVivoxIntegrationModule>("VivoxIntegration");
+	}
+
+	//Shared voice client
+
+	//Loads the vivox core module and returns its voice client without initializing it , null when built without the vivox backend
+	IClient* LoadVoiceClient();
+
+	/*
+	  Adds a user of the shared voice client , the first user initializes it
+	  Every game instance (multi client PIE) shares the one client and keeps its own login session on it , local players of one game instance share its single login
+	  Returns true if this call initialized the client
+	*/
+	bool AcquireVoiceClient();
+
+	//Removes a user of the shared voice client , the last user uninitializes it
+	void ReleaseVoiceClient();
+
+	int32 GetVoiceClientRefCount() const { return VoiceClientRefCount; }
 
 private:
 	class UVivoxSettings* Settings = nullptr;
+
+	IClient* SharedVoiceClient = nullptr;
+	int32 VoiceClientRefCount = 0;
 };
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Engine/EngineTypes.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//
 #include "VivoxSettings.generated.h"
 
 
@@ -24,6 +28,24 @@ enum class EVivoxAudioFadeModel : uint8
     ExponentialByDistance
 };
 
+//Limits on how many channels can be open at once, 0 means no limit
+USTRUCT(BlueprintType)
+struct FVivoxChannelBudget
+{
+	GENERATED_USTRUCT_BODY()
+
+	/*
+	  Max channels with audio connected, extra channels are demoted to text only
+	*/
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	int32 MaxAudioConnectedChannels = 0;
+
+	/*
+	  Max joined channels, extra channels are left
+	*/
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	int32 MaxJoinedChannels = 0;
+};
 
 UCLASS(config = Game, defaultconfig)
 class VIVOXINTEGRATION_API UVivoxSettings : public UObject
@@ -42,4 +64,220 @@ public:
 
 	UPROPERTY(Config, EditAnywhere, Category = "Vivox|PostionalChannel")
     EVivoxAudioFadeModel AudioModel;
+
+	/*
+	  If true, non positional channels with no speech for IdleAudioSuspendSeconds drop their audio connection (text and roster stay connected) and resume it when someone joins , sends text or the channel is rechecked
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|IdleSuspend")
+	bool bEnableIdleAudioSuspend = false;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|IdleSuspend", meta = (UIMin = "5.0", ClampMin = "1.0", EditCondition = "bEnableIdleAudioSuspend"))
+	float IdleAudioSuspendSeconds = 30.0f;
+
+	/*
+	  If false, channels the local player is transmitting into are never suspended so the first words spoken into them are not lost
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|IdleSuspend", meta = (EditCondition = "bEnableIdleAudioSuspend"))
+	bool bIdleSuspendTransmittingChannels = false;
+
+	/*
+	  Speech is not reported for a channel without audio , so a suspended channel reconnects its audio this often to listen for IdleSuspendRecheckListenSeconds , 0 only wakes on roster , text and WakeFromIdle
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|IdleSuspend", meta = (ClampMin = "0.0", EditCondition = "bEnableIdleAudioSuspend"))
+	float IdleSuspendRecheckSeconds = 20.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|IdleSuspend", meta = (ClampMin = "0.5", EditCondition = "bEnableIdleAudioSuspend"))
+	float IdleSuspendRecheckListenSeconds = 3.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|ChannelBudget")
+	FVivoxChannelBudget DefaultChannelBudget;
+
+	/*
+	  Budget overrides keyed by ini platform name (Windows, Android, IOS, Switch...)
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|ChannelBudget")
+	TMap<FString, FVivoxChannelBudget> PlatformChannelBudgets;
+
+	/*
+	  Delay before a desired channel whose join failed or whose connection was lost is joined again , doubled on every failure up to DesiredChannelMaxRetrySeconds
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|DesiredChannels", meta = (ClampMin = "0.1"))
+	float DesiredChannelRetrySeconds = 2.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|DesiredChannels", meta = (ClampMin = "1.0"))
+	float DesiredChannelMaxRetrySeconds = 60.0f;
+
+	/*
+	  Channels left per frame by LogoutAsync / BeginLogout , the session logs out after the last batch
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Logout", meta = (ClampMin = "1"))
+	int32 LogoutChannelsPerFrame = 4;
+
+	/*
+	  Number of received text messages kept per channel, the oldest are dropped once full
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Text", meta = (ClampMin = "0"))
+	int32 TextHistoryCapacity = 100;
+
+	/*
+	  Text sends per second allowed per channel, queued messages are merged into one send while waiting
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Text", meta = (ClampMin = "0.1"))
+	float MaxTextSendsPerSecond = 2.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Text", meta = (ClampMin = "1"))
+	int32 TextSendBurst = 3;
+
+	/*
+	  Pending outbound messages per channel, new messages are dropped once full
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Text", meta = (ClampMin = "1"))
+	int32 MaxQueuedTextMessages = 16;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Text", meta = (ClampMin = "1"))
+	int32 MaxTextMessageLength = 512;
+
+	/*
+	  If true, InitializeVivox applies the saved voice profile (devices, volumes, mute states)
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|VoiceProfile")
+	bool bApplyVoiceProfileOnInitialize = true;
+
+	/*
+	  Channels joined right after login by BeginVivoxBootstrap
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Bootstrap")
+	TArray<FVivoxAutoJoinChannel> AutoJoinChannels;
+
+	/*
+	  The login and auto join stages of BeginVivoxBootstrap fail after this long without a callback , 0 waits forever
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Bootstrap", meta = (ClampMin = "0.0"))
+	float BootstrapStageTimeoutSeconds = 30.0f;
+
+	/*
+	  Participants a shard of a sharded channel is sized for , the shard count is the expected room size divided by this
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Sharding", meta = (ClampMin = "2"))
+	int32 MaxParticipantsPerShard = 40;
+
+	/*
+	  If true, positional channels trace from the listener to every registered participant actor and lower the volume of participants behind walls
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Occlusion")
+	bool bEnableVoiceOcclusion = false;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Occlusion")
+	TEnumAsByte<ECollisionChannel> OcclusionTraceChannel = ECC_Visibility;
+
+	/*
+	  Async traces started per positional channel per frame , participants are traced round robin so 64 participants at 8 traces refresh every 8 frames
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Occlusion", meta = (ClampMin = "1"))
+	int32 OcclusionTracesPerFrame = 8;
+
+	/*
+	  Local volume adjustment of a fully occluded participant (-50 to 0 , 0 keeps the distance volume)
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Occlusion", meta = (ClampMin = "-50", ClampMax = "0"))
+	int32 OccludedVolumeAdjustment = -20;
+
+	/*
+	  How fast the volume follows occlusion changes , higher is snappier
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Occlusion", meta = (ClampMin = "0.1"))
+	float OcclusionSmoothingSpeed = 5.0f;
+
+	/*
+	  If true, voice performance records (init , login , join , leave timings , reconnects , device failovers , position rates , participant peaks) are appended as json lines to Saved/Vivox/Metrics
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Metrics")
+	bool bEnableMetricsLog = false;
+
+	/*
+	  Records waiting for the writer thread , new records are dropped once full
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Metrics", meta = (ClampMin = "1"))
+	int32 MetricsMaxQueuedRecords = 512;
+
+	/*
+	  Size a metrics file is rotated at
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Metrics", meta = (ClampMin = "1"))
+	int32 MetricsMaxFileSizeKB = 1024;
+
+	/*
+	  Metrics files kept including the current one
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Metrics", meta = (ClampMin = "1"))
+	int32 MetricsMaxFiles = 4;
+
+	/*
+	  Seconds between position rate and participant samples of every channel
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Metrics", meta = (ClampMin = "1.0"))
+	float MetricsSampleSeconds = 30.0f;
+
+	/*
+	  Energy (0 to 1) a burst of the self participant has to reach to count as a speech onset or its echo in a voice self test
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|SelfTest", meta = (ClampMin = "0.01", ClampMax = "1.0"))
+	float SelfTestReturnEnergyThreshold = 0.1f;
+
+	/*
+	  Input energy (0 to 1) at or above which a speaking sample counts as clipped
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|SelfTest", meta = (ClampMin = "0.5", ClampMax = "1.0"))
+	float SelfTestClipEnergy = 0.98f;
+
+	/*
+	  A speech onset whose echo did not return within this time is counted as missed
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|SelfTest", meta = (ClampMin = "0.1"))
+	float SelfTestMaxRoundTripSeconds = 2.0f;
+
+	/*
+	  Round trip latency simulated by the loopback stand in backend used for offline self tests
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|SelfTest", meta = (ClampMin = "0"))
+	float LoopbackLatencyMs = 150.0f;
+
+	/*
+	  Random variation added to every loopback round trip (plus or minus)
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|SelfTest", meta = (ClampMin = "0"))
+	float LoopbackJitterMs = 20.0f;
+
+	/*
+	  If true, login and join tokens are minted by the server (VivoxTokenIssuer module) and delivered through UVivoxChannelAssignmentComponent , clients never need the TokenKey
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Tokens")
+	bool bUseServerIssuedTokens = false;
+
+	/*
+	  Lifetime of server issued tokens , tokens are cached and reused until TokenRefreshMarginSeconds before they expire
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Tokens", meta = (ClampMin = "60"))
+	int32 IssuedTokenLifetimeSeconds = 600;
+
+	/*
+	  Players get fresh tokens this long before their current ones expire
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Tokens", meta = (ClampMin = "10"))
+	int32 TokenRefreshMarginSeconds = 60;
+
+	/*
+	  If true, the voice state is published once per frame for reading from any thread (UVivoxSubSystem::ReadVoiceState) , off by default as it costs a copy of every roster each frame
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|Snapshot")
+	bool bPublishVoiceStateSnapshot = false;
+
+	/*
+	  If true, the vivox subsystem is not created on clients that can never render (-nullrhi headless bots) , -NoVivox skips it on any client
+	*/
+	UPROPERTY(Config, EditAnywhere, Category = "Vivox|NullBackend")
+	bool bDisableOnHeadlessClients = true;
+
+	//Gets the channel budget of the running platform
+	const FVivoxChannelBudget& GetChannelBudget() const;
 };
@@ -0,0 +1,46 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "VivoxVoiceProfile.generated.h"
+
+/*
+  Per user voice device and volume choices saved in GameUserSettings.ini and applied in one batch by InitializeVivox
+*/
+UCLASS(config = GameUserSettings)
+class VIVOXINTEGRATION_API UVivoxVoiceProfile : public UObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	UPROPERTY(Config)
+	bool bHasSavedProfile = false;
+
+	UPROPERTY(Config)
+	FString InputDeviceId;
+
+	UPROPERTY(Config)
+	FString InputDeviceName;
+
+	UPROPERTY(Config)
+	FString OutputDeviceId;
+
+	UPROPERTY(Config)
+	FString OutputDeviceName;
+
+	//Volume range is from 0 to 100 like SetInputDeviceVolume
+	UPROPERTY(Config)
+	int32 InputVolume = 50;
+
+	//Volume range is from 0 to 100 like SetOutputDeviceVolume
+	UPROPERTY(Config)
+	int32 OutputVolume = 50;
+
+	UPROPERTY(Config)
+	bool bInputMuted = false;
+
+	UPROPERTY(Config)
+	bool bOutputMuted = false;
+};
@@ -24,6 +24,8 @@ public class VivoxIntegration : ModuleRules
 			new string[]
 			{
 				"Core",
+				"Json",
+				"NetCore",
 				"VivoxCore"
 			}
 			);
@@ -45,5 +47,9 @@ public class VivoxIntegration : ModuleRules
 			{
 			}
 			);
+
+		// Dedicated servers never talk to vivox , VivoxCore is still linked for the types of the public api but the voice client is never created or initialized
+		bool bWithVivoxBackend = Target.Type != TargetType.Server;
+		PublicDefinitions.Add("WITH_VIVOX_BACKEND=" + (bWithVivoxBackend ? "1" : "0"));
 	}
 }
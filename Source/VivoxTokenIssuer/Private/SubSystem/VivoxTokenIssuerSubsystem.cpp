@@ -0,0 +1,212 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "SubSystem/VivoxTokenIssuerSubsystem.h"
+#include "VivoxTokenIssuer.h"
+//VivoxSettings
+#include "VivoxSettings.h"
+//
+//Components
+#include "Components/VivoxChannelAssignmentComponent.h"
+//
+#include "Async/ParallelFor.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "HAL/PlatformMisc.h"
+
+//USubsystem
+
+void UVivoxTokenIssuerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SetSigningCredentials(ReadConfigValue(TEXT("VIVOX_ISSUER"), TEXT("VivoxIssuer=")), ReadConfigValue(TEXT("VIVOX_DOMAIN"), TEXT("VivoxDomain=")),
+		ReadConfigValue(TEXT("VIVOX_TOKEN_KEY"), TEXT("VivoxTokenKey=")));
+	AssignmentsChangedHandle = UVivoxChannelAssignmentComponent::OnServerAssignmentsChanged.AddUObject(this, &UVivoxTokenIssuerSubsystem::OnServerAssignmentsChanged);
+}
+
+void UVivoxTokenIssuerSubsystem::Deinitialize()
+{
+	UVivoxChannelAssignmentComponent::OnServerAssignmentsChanged.Remove(AssignmentsChangedHandle);
+	PendingPlayers.Empty();
+	RefreshTimes.Empty();
+	TokenCache.Empty();
+	Minter.Reset();
+	Super::Deinitialize();
+}
+
+FString UVivoxTokenIssuerSubsystem::ReadConfigValue(const TCHAR* EnvironmentVariable, const TCHAR* CommandLineSwitch)
+{
+	FString Value;
+	if (!FParse::Value(FCommandLine::Get(), CommandLineSwitch, Value))
+	{
+		Value = FPlatformMisc::GetEnvironmentVariable(EnvironmentVariable);
+	}
+	return Value;
+}
+
+void UVivoxTokenIssuerSubsystem::SetSigningCredentials(const FString& Issuer, const FString& Domain, const FString& TokenKey)
+{
+	Minter = MakeUnique<FVivoxTokenMinter>(Issuer, Domain, TokenKey);
+	TokenCache.Empty();
+}
+
+//FTickableGameObject
+
+void UVivoxTokenIssuerSubsystem::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	for (auto It = RefreshTimes.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+		else if (Now >= It.Value())
+		{
+			PendingPlayers.AddUnique(It.Key());
+		}
+	}
+
+	if (PendingPlayers.Num() == 0)
+		return;
+
+	TArray<UVivoxChannelAssignmentComponent*> Players;
+	Players.Reserve(PendingPlayers.Num());
+	for (const TWeakObjectPtr<UVivoxChannelAssignmentComponent>& Player : PendingPlayers)
+	{
+		if (UVivoxChannelAssignmentComponent* Component = Player.Get())
+		{
+			Players.Add(Component);
+		}
+	}
+	PendingPlayers.Reset();
+	IssueTokens(Players);
+}
+
+ETickableTickType UVivoxTokenIssuerSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UVivoxTokenIssuerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVivoxTokenIssuerSubsystem, STATGROUP_Tickables);
+}
+
+//Issuing
+
+void UVivoxTokenIssuerSubsystem::OnServerAssignmentsChanged(UVivoxChannelAssignmentComponent* Component)
+{
+	//The delegate is shared by every game instance (PIE)
+	const UWorld* World = Component ? Component->GetWorld() : nullptr;
+	if (World == nullptr || World->GetGameInstance() != GetGameInstance())
+		return;
+
+	PendingPlayers.AddUnique(Component);
+}
+
+void UVivoxTokenIssuerSubsystem::PruneTokenCache(int64 Now)
+{
+	for (auto It = TokenCache.CreateIterator(); It; ++It)
+	{
+		if (It.Value().ExpiresAt <= Now)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+int32 UVivoxTokenIssuerSubsystem::IssueTokens(const TArray<UVivoxChannelAssignmentComponent*>& Players)
+{
+	LLM_SCOPE_BYTAG(Vivox);
+	if (!CanIssueTokens())
+	{
+		UE_LOG(LogVivoxTokenIssuer, Error, TEXT("Vivox token issuer has no signing credentials , set VIVOX_ISSUER , VIVOX_DOMAIN and VIVOX_TOKEN_KEY"));
+		return 0;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const UVivoxSettings* Setting = GetDefault<UVivoxSettings>();
+	const int64 Now = FDateTime::UtcNow().ToUnixTimestamp();
+	const int64 ExpiresAt = Now + Setting->IssuedTokenLifetimeSeconds;
+	const int64 ReuseUntil = Now + Setting->TokenRefreshMarginSeconds;
+	PruneTokenCache(Now);
+
+	//Gathered on the game thread , cached tokens are taken as they are
+	TArray<FVivoxTokenRequest> Requests;
+	TArray<FVivoxIssuedToken> Tokens;
+	TArray<int32> PlayerFirstToken;
+	TArray<int32> MintIndices;
+	PlayerFirstToken.Reserve(Players.Num() + 1);
+
+	for (UVivoxChannelAssignmentComponent* Player : Players)
+	{
+		PlayerFirstToken.Add(Requests.Num());
+		if (!IsValid(Player))
+			continue;
+
+		const FString& AccountName = Player->GetOrCreateVivoxAccountName();
+		FVivoxTokenRequest& LoginRequest = Requests.AddDefaulted_GetRef();
+		LoginRequest.Action = EVivoxTokenAction::Login;
+		LoginRequest.AccountName = AccountName;
+
+		for (const FVivoxDesiredChannel& Channel : Player->GetAssignedChannels())
+		{
+			FVivoxTokenRequest& JoinRequest = Requests.AddDefaulted_GetRef();
+			JoinRequest.Action = EVivoxTokenAction::Join;
+			JoinRequest.AccountName = AccountName;
+			JoinRequest.ChannelSessionId = Channel.ChannelSessionId;
+			JoinRequest.ChannelType = Channel.ChannelType;
+		}
+	}
+	PlayerFirstToken.Add(Requests.Num());
+
+	Tokens.SetNum(Requests.Num());
+	for (int32 Index = 0; Index < Requests.Num(); ++Index)
+	{
+		const FVivoxIssuedToken* Cached = TokenCache.Find(Requests[Index].MakeCacheKey());
+		if (Cached != nullptr && Cached->ExpiresAt > ReuseUntil)
+		{
+			Tokens[Index] = *Cached;
+		}
+		else
+		{
+			MintIndices.Add(Index);
+		}
+	}
+
+	//Every index writes its own slot , the minter only shares its atomic serial
+	const FVivoxTokenMinter& TokenMinter = *Minter;
+	ParallelFor(MintIndices.Num(), [&Requests, &Tokens, &MintIndices, &TokenMinter, ExpiresAt](int32 Index)
+		{
+			const int32 RequestIndex = MintIndices[Index];
+			Tokens[RequestIndex] = TokenMinter.Mint(Requests[RequestIndex], ExpiresAt);
+		});
+
+	for (const int32 RequestIndex : MintIndices)
+	{
+		TokenCache.Add(Requests[RequestIndex].MakeCacheKey(), Tokens[RequestIndex]);
+	}
+
+	//Players get fresh tokens before the ones sent now expire
+	const double RefreshTime = FPlatformTime::Seconds() + FMath::Max(Setting->IssuedTokenLifetimeSeconds - Setting->TokenRefreshMarginSeconds, 1);
+	int32 NumSent = 0;
+	for (int32 PlayerIndex = 0; PlayerIndex < Players.Num(); ++PlayerIndex)
+	{
+		const int32 First = PlayerFirstToken[PlayerIndex];
+		const int32 Count = PlayerFirstToken[PlayerIndex + 1] - First;
+		if (Count == 0)
+			continue;
+
+		TArray<FVivoxIssuedToken> PlayerTokens(Tokens.GetData() + First, Count);
+		Players[PlayerIndex]->SendVivoxTokens(PlayerTokens);
+		RefreshTimes.Add(Players[PlayerIndex], RefreshTime);
+		NumSent += Count;
+	}
+
+	UE_LOG(LogVivoxTokenIssuer, Log, TEXT("Issued %d vivox tokens (%d minted) for %d players in %.3f ms"), NumSent, MintIndices.Num(), Players.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return NumSent;
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+
+#include "Token/VivoxTokenMinter.h"
+//Objects
+#include "Objects/VivoxPositionalChannelObject.h"
+//
+#include "Misc/Base64.h"
+
+THIRD_PARTY_INCLUDES_START
+#define UI UI_ST
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#undef UI
+THIRD_PARTY_INCLUDES_END
+
+namespace VivoxTokenMinter
+{
+	//Base64url of "{}" , vivox tokens carry an empty header
+	static const TCHAR* Header = TEXT("e30");
+
+	static FString EscapeJson(const FString& Value)
+	{
+		return Value.Replace(TEXT("\\"), TEXT("\\\\")).Replace(TEXT("\""), TEXT("\\\""));
+	}
+
+	static const TCHAR* ActionToString(EVivoxTokenAction Action)
+	{
+		return Action == EVivoxTokenAction::Login ? TEXT("login") : TEXT("join");
+	}
+}
+
+FString FVivoxTokenRequest::MakeCacheKey() const
+{
+	return FString::Printf(TEXT("%d:%s:%d:%s"), static_cast<int32>(Action), *AccountName, static_cast<int32>(ChannelType), *ChannelSessionId);
+}
+
+FVivoxTokenMinter::FVivoxTokenMinter(const FString& InIssuer, const FString& InDomain, const FString& InKey)
+	: Issuer(InIssuer)
+	, Domain(InDomain)
+	, NextSerial(static_cast<uint64>(FDateTime::UtcNow().ToUnixTimestamp()) << 16)
+{
+	FTCHARToUTF8 KeyUtf8(*InKey);
+	Key.Append(reinterpret_cast<const uint8*>(KeyUtf8.Get()), KeyUtf8.Length());
+
+	//Same properties the positional channel object joins with
+	PositionalProperties = UVivoxPositionalChannelObject::MakeChannel3DProperties();
+}
+
+bool FVivoxTokenMinter::IsValid() const
+{
+	return Issuer != "" && Domain != "" && Key.Num() > 0;
+}
+
+FString FVivoxTokenMinter::MakeUserUri(const FString& AccountName) const
+{
+	return AccountId(Issuer, AccountName, Domain).ToString();
+}
+
+FString FVivoxTokenMinter::MakeChannelUri(EVivoxChannelType VivoxChannelType, const FString& ChannelSessionId) const
+{
+	//Named apart from the sdk ChannelType enum used below
+	switch (VivoxChannelType)
+	{
+	case EVivoxChannelType::Positional:
+		return ChannelId(Issuer, ChannelSessionId, Domain, ChannelType::Positional, PositionalProperties).ToString();
+	case EVivoxChannelType::Echo:
+		return ChannelId(Issuer, ChannelSessionId, Domain, ChannelType::Echo).ToString();
+	case EVivoxChannelType::NonPositional:
+	default:
+		return ChannelId(Issuer, ChannelSessionId, Domain, ChannelType::NonPositional).ToString();
+	}
+}
+
+FString FVivoxTokenMinter::Base64UrlEncode(const uint8* Data, int32 Num)
+{
+	FString Encoded = FBase64::Encode(Data, Num);
+	Encoded.ReplaceCharInline(TEXT('+'), TEXT('-'));
+	Encoded.ReplaceCharInline(TEXT('/'), TEXT('_'));
+	int32 Length = Encoded.Len();
+	while (Length > 0 && Encoded[Length - 1] == TEXT('='))
+	{
+		--Length;
+	}
+	Encoded.LeftInline(Length);
+	return Encoded;
+}
+
+FVivoxIssuedToken FVivoxTokenMinter::Mint(const FVivoxTokenRequest& Request, int64 ExpiresAt) const
+{
+	FVivoxIssuedToken Issued;
+	Issued.Action = Request.Action;
+	Issued.AccountName = Request.AccountName;
+	Issued.ChannelSessionId = Request.ChannelSessionId;
+	Issued.ChannelType = Request.ChannelType;
+	Issued.ExpiresAt = ExpiresAt;
+
+	const uint64 Serial = NextSerial.fetch_add(1, std::memory_order_relaxed);
+	FString Claims = FString::Printf(TEXT("{\"iss\":\"%s\",\"exp\":%lld,\"vxa\":\"%s\",\"vxi\":%llu,\"f\":\"%s\""),
+		*VivoxTokenMinter::EscapeJson(Issuer), ExpiresAt, VivoxTokenMinter::ActionToString(Request.Action), Serial, *VivoxTokenMinter::EscapeJson(MakeUserUri(Request.AccountName)));
+	if (Request.Action == EVivoxTokenAction::Join)
+	{
+		Claims += FString::Printf(TEXT(",\"t\":\"%s\""), *VivoxTokenMinter::EscapeJson(MakeChannelUri(Request.ChannelType, Request.ChannelSessionId)));
+	}
+	Claims += TEXT("}");
+
+	FTCHARToUTF8 ClaimsUtf8(*Claims);
+	const FString SignedPart = FString::Printf(TEXT("%s.%s"), VivoxTokenMinter::Header, *Base64UrlEncode(reinterpret_cast<const uint8*>(ClaimsUtf8.Get()), ClaimsUtf8.Length()));
+
+	FTCHARToUTF8 SignedPartUtf8(*SignedPart);
+	uint8 Signature[EVP_MAX_MD_SIZE];
+	unsigned int SignatureLength = 0;
+	HMAC(EVP_sha256(), Key.GetData(), Key.Num(), reinterpret_cast<const unsigned char*>(SignedPartUtf8.Get()), SignedPartUtf8.Length(), Signature, &SignatureLength);
+
+	Issued.Token = SignedPart + TEXT(".") + Base64UrlEncode(Signature, static_cast<int32>(SignatureLength));
+	return Issued;
+}
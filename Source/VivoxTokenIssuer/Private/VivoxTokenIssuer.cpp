@@ -0,0 +1,15 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#include "VivoxTokenIssuer.h"
+
+DEFINE_LOG_CATEGORY(LogVivoxTokenIssuer);
+
+void FVivoxTokenIssuerModule::StartupModule()
+{
+}
+
+void FVivoxTokenIssuerModule::ShutdownModule()
+{
+}
+
+IMPLEMENT_MODULE(FVivoxTokenIssuerModule, VivoxTokenIssuer)
@@ -0,0 +1,69 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+//Token
+#include "Token/VivoxTokenMinter.h"
+//
+#include "VivoxTokenIssuerSubsystem.generated.h"
+
+class UVivoxChannelAssignmentComponent;
+
+/*
+  Mints the login and join tokens of every player on the server and sends them to the owning clients through UVivoxChannelAssignmentComponent
+  Players whose assignment changed in a frame are issued together on the next tick , tokens are minted in parallel on the task graph and cached until shortly before they expire
+  The signing key is read from the VIVOX_TOKEN_KEY environment variable or -VivoxTokenKey= , the issuer and domain from VIVOX_ISSUER / -VivoxIssuer= and VIVOX_DOMAIN / -VivoxDomain=
+*/
+UCLASS()
+class VIVOXTOKENISSUER_API UVivoxTokenIssuerSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+private:
+
+	TUniquePtr<FVivoxTokenMinter> Minter;
+	FDelegateHandle AssignmentsChangedHandle;
+
+	//Players issued on the next tick
+	TArray<TWeakObjectPtr<UVivoxChannelAssignmentComponent>> PendingPlayers;
+
+	//Players issued again before their tokens expire
+	TMap<TWeakObjectPtr<UVivoxChannelAssignmentComponent>, double> RefreshTimes;
+
+	//Minted tokens keyed by FVivoxTokenRequest::MakeCacheKey
+	TMap<FString, FVivoxIssuedToken> TokenCache;
+
+	void OnServerAssignmentsChanged(UVivoxChannelAssignmentComponent* Component);
+	void PruneTokenCache(int64 Now);
+	static FString ReadConfigValue(const TCHAR* EnvironmentVariable, const TCHAR* CommandLineSwitch);
+
+public:
+
+	//USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return PendingPlayers.Num() > 0 || RefreshTimes.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+
+	/*
+	  Sets the signing credentials in code instead of the environment , server only
+	*/
+	void SetSigningCredentials(const FString& Issuer, const FString& Domain, const FString& TokenKey);
+
+	bool CanIssueTokens() const { return Minter.IsValid() && Minter->IsValid(); }
+
+	/*
+	  Mints and sends the login token and the join tokens of the assigned channels of every player , cached tokens are reused
+	  @param Players Assignment components of the players
+	  Returns the number of tokens sent
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Vivox|Tokens")
+	int32 IssueTokens(const TArray<UVivoxChannelAssignmentComponent*>& Players);
+};
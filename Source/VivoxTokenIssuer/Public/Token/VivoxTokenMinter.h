@@ -0,0 +1,54 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+//Resource
+#include "Resource/VivoxResource.h"
+//Vivox
+#include "VivoxCore.h"
+//
+#include <atomic>
+
+//What a token is minted for
+struct FVivoxTokenRequest
+{
+	EVivoxTokenAction Action = EVivoxTokenAction::Login;
+	FString AccountName;
+	FString ChannelSessionId;
+	EVivoxChannelType ChannelType = EVivoxChannelType::NonPositional;
+
+	//Tokens of equal requests are interchangeable , used as the cache key
+	FString MakeCacheKey() const;
+};
+
+/*
+  Mints vivox access tokens (base64url header "e30" , json claims iss exp vxa vxi f t , HMAC-SHA256 signature)
+  The sip addresses are built by the vivox sdk AccountId and ChannelId , so the tokens match what the clients connect to
+  Mint is thread safe , the minter is immutable after construction apart from the token serial
+*/
+class VIVOXTOKENISSUER_API FVivoxTokenMinter
+{
+public:
+	FVivoxTokenMinter(const FString& InIssuer, const FString& InDomain, const FString& InKey);
+
+	bool IsValid() const;
+
+	FVivoxIssuedToken Mint(const FVivoxTokenRequest& Request, int64 ExpiresAt) const;
+
+	FString MakeUserUri(const FString& AccountName) const;
+	FString MakeChannelUri(EVivoxChannelType VivoxChannelType, const FString& ChannelSessionId) const;
+
+	static FString Base64UrlEncode(const uint8* Data, int32 Num);
+
+private:
+	FString Issuer;
+	FString Domain;
+	TArray<uint8> Key;
+
+	//Positional channel properties , read from the vivox settings once on the game thread
+	Channel3DProperties PositionalProperties;
+
+	//vxi , unique per token
+	mutable std::atomic<uint64> NextSerial;
+};
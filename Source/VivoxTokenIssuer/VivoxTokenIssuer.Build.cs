@@ -0,0 +1,24 @@
+// Copyright (c) 2025 , SPD78. All rights reserved.
+
+using UnrealBuildTool;
+
+public class VivoxTokenIssuer : ModuleRules
+{
+	public VivoxTokenIssuer(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"VivoxIntegration"
+			}
+			);
+
+		// Tokens are signed with HMAC-SHA256 , the key never leaves the server
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "OpenSSL");
+	}
+}